@@ -0,0 +1,142 @@
+//
+// AVLTree.cpp
+//
+// Invariant: for every node, |height(left) - height(right)| <= 1.
+// Insert walks down once (recording the links it followed), then walks the same
+// links back up fixing heights and rotating where the invariant broke. No recursion
+// anywhere, so very large vocabularies cannot overflow the call stack; teardown is
+// the node arena's linear release.
+//
+
+#include "AVLTree.h"
+
+void AVLTree::insert(std::string_view word) {
+    insert(word, 1);
+}
+
+void AVLTree::insert(std::string_view word, size_t count) {
+    Node** path[kMaxHeight];
+    int depth = 0;
+
+    // 1) Descend; an existing word just gets its count bumped.
+    Node** link = &root_;
+    while (*link) {
+        Node* n = *link;
+        const int c = word.compare(n->word);
+        if (c == 0) {
+            n->count += count;
+            return;
+        }
+        path[depth++] = link;
+        link = c < 0 ? &n->left : &n->right;
+    }
+    *link = nodes_.make(std::string(word), count);
+
+    // 2) Walk back up. Once a subtree's height is unchanged (or a rotation restored
+    //    it), nothing above can be out of balance, so we stop early.
+    while (depth > 0) {
+        Node** l = path[--depth];
+        const unsigned char before = (*l)->height;
+        *l = rebalance(*l);
+        if ((*l)->height == before) break;
+    }
+}
+
+void AVLTree::bulkInsert(const std::vector<std::string>& words) {
+    for (const auto& w : words) insert(w);
+}
+
+void AVLTree::bulkInsert(const std::vector<std::string_view>& words) {
+    for (const auto w : words) insert(w);
+}
+
+bool AVLTree::contains(std::string_view w) const noexcept {
+    return findNode(w) != nullptr;
+}
+
+std::optional<size_t> AVLTree::countOf(std::string_view w) const noexcept {
+    const Node* n = findNode(w);
+    if (!n) return std::nullopt;
+    return n->count;
+}
+
+void AVLTree::inorderCollect(std::vector<std::pair<std::string, size_t>>& out) const {
+    // Explicit stack instead of recursion; depth is bounded by the tree height.
+    const Node* stack[kMaxHeight];
+    int top = 0;
+    const Node* n = root_;
+    while (n || top > 0) {
+        while (n) {
+            stack[top++] = n;
+            n = n->left;
+        }
+        n = stack[--top];
+        out.emplace_back(n->word, n->count);
+        n = n->right;
+    }
+}
+
+size_t AVLTree::size() const noexcept {
+    return nodes_.size();
+}
+
+unsigned AVLTree::height() const noexcept {
+    return heightOf(root_);
+}
+
+// ===============================
+//  Private helpers
+// ===============================
+
+void AVLTree::update(Node* n) noexcept {
+    const unsigned char hl = heightOf(n->left);
+    const unsigned char hr = heightOf(n->right);
+    n->height = static_cast<unsigned char>(1 + (hl > hr ? hl : hr));
+}
+
+AVLTree::Node* AVLTree::rotateLeft(Node* n) noexcept {
+    // n's right child r becomes the subtree root; r's old left subtree
+    // moves under n as its new right subtree.
+    Node* r = n->right;
+    n->right = r->left;
+    r->left = n;
+    update(n);
+    update(r);
+    return r;
+}
+
+AVLTree::Node* AVLTree::rotateRight(Node* n) noexcept {
+    // Mirror image of rotateLeft.
+    Node* l = n->left;
+    n->left = l->right;
+    l->right = n;
+    update(n);
+    update(l);
+    return l;
+}
+
+AVLTree::Node* AVLTree::rebalance(Node* n) noexcept {
+    update(n);
+    const int balance = heightOf(n->left) - heightOf(n->right);
+    if (balance > 1) {
+        // Left-heavy; a left-right shape needs the child rotated first.
+        if (heightOf(n->left->left) < heightOf(n->left->right)) n->left = rotateLeft(n->left);
+        return rotateRight(n);
+    }
+    if (balance < -1) {
+        // Right-heavy; mirror of the above.
+        if (heightOf(n->right->right) < heightOf(n->right->left)) n->right = rotateRight(n->right);
+        return rotateLeft(n);
+    }
+    return n;
+}
+
+const AVLTree::Node* AVLTree::findNode(std::string_view w) const noexcept {
+    const Node* n = root_;
+    while (n) {
+        const int c = w.compare(n->word);
+        if (c == 0) return n;
+        n = c < 0 ? n->left : n->right;
+    }
+    return nullptr;
+}
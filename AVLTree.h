@@ -0,0 +1,71 @@
+//
+// AVLTree.h
+//
+// Self-balancing (AVL) drop-in for BST as the word-frequency counter.
+// Same public API as BST, but every operation is iterative and the tree is
+// rebalanced on insert, so height stays <= ~1.44 log2(V) even for sorted input
+// (word lists, dictionaries) where the plain BST degrades into a linked list.
+//
+
+#ifndef IMPLEMENTATION_AVLTREE_H
+#define IMPLEMENTATION_AVLTREE_H
+
+#pragma once
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "NodeArena.h"
+#include "FrequencyCounter.h"
+
+class AVLTree : public FrequencyCounter {
+public:
+    AVLTree() = default;
+    ~AVLTree() override = default; // the arena releases every node at once
+
+    // Owns its nodes: non-copyable.
+    AVLTree(const AVLTree&) = delete;
+    AVLTree& operator=(const AVLTree&) = delete;
+
+    void insert(std::string_view word) override;               // count++
+    void insert(std::string_view word, size_t count) override; // count += count (pre-counted input)
+    void bulkInsert(const std::vector<std::string>&) override; // convenience
+    void bulkInsert(const std::vector<std::string_view>&) override;
+
+    [[nodiscard]] bool contains(std::string_view w) const noexcept;
+    [[nodiscard]] std::optional<size_t> countOf(std::string_view w) const noexcept override;
+
+    // In-order lexicographic (word asc) → flat (word, count); appends to 'out'
+    void inorderCollect(std::vector<std::pair<std::string,size_t>>& out) const override;
+
+    [[nodiscard]] size_t size() const noexcept override;     // distinct words
+    [[nodiscard]] unsigned height() const noexcept override; // empty = 0, single node = 1
+
+private:
+    struct Node {
+        std::string word;
+        size_t count;
+        Node* left = nullptr;
+        Node* right = nullptr;
+        unsigned char height = 1; // subtree height, leaf = 1 (same convention as BST::height)
+
+        Node(std::string w, size_t c) : word(std::move(w)), count(c) {}
+    };
+
+    // AVL height is at most ~1.44 log2(n + 2), so 96 levels covers any 64-bit node count.
+    static constexpr int kMaxHeight = 96;
+
+    Node* root_ = nullptr;
+    NodeArena<Node> nodes_; // every node lives here; size() is nodes_.size()
+
+    static unsigned char heightOf(const Node* n) noexcept { return n ? n->height : 0; }
+    static void update(Node* n) noexcept;
+    static Node* rotateLeft(Node* n) noexcept;
+    static Node* rotateRight(Node* n) noexcept;
+    static Node* rebalance(Node* n) noexcept;
+    const Node* findNode(std::string_view w) const noexcept;
+};
+
+#endif //IMPLEMENTATION_AVLTREE_H
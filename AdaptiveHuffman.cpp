@@ -0,0 +1,271 @@
+//
+// AdaptiveHuffman.cpp
+//
+
+#include "AdaptiveHuffman.h"
+
+#include <string>
+#include <utility>
+
+AdaptiveHuffmanModel::AdaptiveHuffmanModel() {
+    // Empty tree: the NYT leaf (weight 1) is the root.
+    nodes_.emplace_back().weight = 1;
+    order_.push_back(0);
+    first_.push_back(0);
+}
+
+void AdaptiveHuffmanModel::path(std::uint32_t symbol, std::vector<unsigned char>& bits) const {
+    bits.clear();
+    std::uint32_t n = symbol == kNYT ? nyt_ : leafOf_[symbol];
+    while (n != root_) {
+        const std::uint32_t p = nodes_[n].parent;
+        bits.push_back(static_cast<unsigned char>(nodes_[p].child[1] == n));
+        n = p;
+    }
+}
+
+void AdaptiveHuffmanModel::update(std::uint32_t symbol) {
+    if (contains(symbol)) {
+        climb(leafOf_[symbol]);
+        climb(leafOf_[symbol]);
+        return;
+    }
+
+    // Split the NYT: it becomes an internal node over a new NYT (0) and the new leaf
+    // (1), both of weight 1, ranked right after it. Every other node weighs at least
+    // 2, so the three of them form the whole weight-1 block and it still starts at
+    // the old NYT. Raising the old NYT to 2 and the leaf to 2 finishes the update.
+    const std::uint32_t old = nyt_;
+    const auto leaf = static_cast<std::uint32_t>(nodes_.size());
+    const std::uint32_t fresh = leaf + 1;
+    nodes_.resize(nodes_.size() + 2);
+    for (const std::uint32_t m : {leaf, fresh}) {
+        nodes_[m].weight = 1;
+        nodes_[m].parent = old;
+        nodes_[m].block = nodes_[old].block;
+        nodes_[m].rank = static_cast<std::uint32_t>(order_.size());
+        order_.push_back(m);
+    }
+    nodes_[leaf].symbol = symbol;
+    nodes_[old].child[0] = fresh;
+    nodes_[old].child[1] = leaf;
+    nodes_[old].symbol = kNone;
+    if (leafOf_.size() <= symbol) leafOf_.resize(symbol + 1, kNone);
+    leafOf_[symbol] = leaf;
+    nyt_ = fresh;
+
+    climb(old);
+    climb(leaf);
+}
+
+void AdaptiveHuffmanModel::climb(std::uint32_t n) {
+    for (; n != kNone; n = nodes_[n].parent) increment(n);
+}
+
+void AdaptiveHuffmanModel::increment(std::uint32_t n) {
+    // Move to the front of the block first. That node is never an ancestor: every
+    // weight is positive, so a parent outweighs each child.
+    const std::uint32_t b = nodes_[n].block;
+    const std::uint32_t lead = order_[first_[b]];
+    if (lead != n) swapNodes(n, lead);
+
+    const std::uint32_t r = nodes_[n].rank;
+    const std::uint64_t w = ++nodes_[n].weight;
+
+    // The old block now starts one rank later, or is empty. The node joins the block
+    // ranked just before it if that one has the new weight, else starts its own.
+    if (r + 1 < order_.size() && nodes_[order_[r + 1]].block == b) {
+        first_[b] = r + 1;
+    } else {
+        freeBlocks_.push_back(b);
+    }
+    if (r > 0 && nodes_[order_[r - 1]].weight == w) {
+        nodes_[n].block = nodes_[order_[r - 1]].block;
+    } else if (!freeBlocks_.empty()) {
+        nodes_[n].block = freeBlocks_.back();
+        freeBlocks_.pop_back();
+        first_[nodes_[n].block] = r;
+    } else {
+        nodes_[n].block = static_cast<std::uint32_t>(first_.size());
+        first_.push_back(r);
+    }
+}
+
+void AdaptiveHuffmanModel::swapNodes(std::uint32_t a, std::uint32_t b) {
+    // Exchange the two subtrees' places in the tree and in the ranking (equal weights,
+    // so neither is an ancestor of the other).
+    Node& x = nodes_[a];
+    Node& y = nodes_[b];
+    const unsigned xs = nodes_[x.parent].child[1] == a;
+    const unsigned ys = nodes_[y.parent].child[1] == b;
+    nodes_[x.parent].child[xs] = b;
+    nodes_[y.parent].child[ys] = a;
+    std::swap(x.parent, y.parent);
+    std::swap(order_[x.rank], order_[y.rank]);
+    std::swap(x.rank, y.rank);
+}
+
+AdaptiveHuffmanEncoder::AdaptiveHuffmanEncoder(std::ostream& os) : os_(os) {
+    buf_.reserve(kBufferBytes + 64);
+    buf_.insert(buf_.end(), kMagic.begin(), kMagic.end());
+}
+
+void AdaptiveHuffmanEncoder::putCode(const AdaptiveHuffmanModel& model, std::uint32_t symbol) {
+    model.path(symbol, path_);
+    for (auto it = path_.rbegin(); it != path_.rend(); ++it) putBit(*it);
+}
+
+void AdaptiveHuffmanEncoder::putChar(std::uint32_t c) {
+    if (chars_.contains(c)) {
+        putCode(chars_, c);
+    } else {
+        putCode(chars_, AdaptiveHuffmanModel::kNYT);
+        for (int i = 8; i >= 0; --i) putBit((c >> i) & 1);
+    }
+    chars_.update(c);
+}
+
+void AdaptiveHuffmanEncoder::spell(std::string_view word) {
+    putCode(words_, AdaptiveHuffmanModel::kNYT);
+    for (const unsigned char c : word) putChar(c);
+    putChar(kEndOfWord);
+}
+
+error_type AdaptiveHuffmanEncoder::put(std::string_view word) {
+    if (word.empty()) return FAILED_TO_WRITE_FILE; // reserved for the end marker
+    const std::size_t before = ids_.size();
+    const std::uint32_t id = ids_.intern(word);
+    if (ids_.size() == before) putCode(words_, id);
+    else spell(word);
+    words_.update(id);
+    if (buf_.size() >= kBufferBytes) drain();
+    return os_.fail() ? FAILED_TO_WRITE_FILE : NO_ERROR;
+}
+
+void AdaptiveHuffmanEncoder::drain() {
+    os_.write(buf_.data(), static_cast<std::streamsize>(buf_.size()));
+    buf_.clear();
+}
+
+error_type AdaptiveHuffmanEncoder::flush() {
+    drain();
+    os_.flush();
+    return os_.fail() ? FAILED_TO_WRITE_FILE : NO_ERROR;
+}
+
+error_type AdaptiveHuffmanEncoder::finish() {
+    spell({}); // NYT + end of word right away = end of stream
+    while (used_ != 0) putBit(0);
+    return flush();
+}
+
+namespace {
+    // Bits of a stream, MSB first, read in large chunks.
+    class BitReader {
+    public:
+        explicit BitReader(std::istream& in) : in_(in), buf_(64 * 1024) {}
+
+        // Next bit, or -1 at the end of the stream.
+        int bit() {
+            if (used_ == 0) {
+                if (at_ == size_ && !refill()) return -1;
+                byte_ = static_cast<unsigned char>(buf_[at_++]);
+                used_ = 8;
+            }
+            --used_;
+            return (byte_ >> used_) & 1;
+        }
+
+        // The next n bytes, whole (false if the stream ends first). Only used at the start.
+        bool bytes(char* out, std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i) {
+                if (at_ == size_ && !refill()) return false;
+                out[i] = buf_[at_++];
+            }
+            return true;
+        }
+
+        [[nodiscard]] bool bad() const { return in_.bad(); }
+
+    private:
+        std::istream& in_;
+        std::vector<char> buf_;
+        std::size_t at_ = 0, size_ = 0;
+        unsigned char byte_ = 0;
+        unsigned used_ = 0;
+
+        bool refill() {
+            in_.read(buf_.data(), static_cast<std::streamsize>(buf_.size()));
+            size_ = static_cast<std::size_t>(in_.gcount());
+            at_ = 0;
+            return size_ != 0;
+        }
+    };
+
+    // Walk 'model' from the root along the input bits; false if the input runs out.
+    bool readSymbol(const AdaptiveHuffmanModel& model, BitReader& in, std::uint32_t& symbol) {
+        std::uint32_t n = model.root();
+        while (!model.isLeaf(n)) {
+            const int b = in.bit();
+            if (b < 0) return false;
+            n = model.child(n, static_cast<unsigned>(b));
+        }
+        symbol = model.symbol(n);
+        return true;
+    }
+}
+
+error_type AdaptiveHuffmanDecoder::decode(std::istream& code, std::ostream& tokens) {
+    BitReader in(code);
+    char magic[4];
+    if (!in.bytes(magic, sizeof magic) || std::string_view(magic, sizeof magic) != kMagic) {
+        return in.bad() ? UNABLE_TO_OPEN_FILE : CORRUPT_INPUT;
+    }
+
+    AdaptiveHuffmanModel words, chars;
+    SymbolTable ids;
+    constexpr std::uint32_t kEndOfWord = 256;
+    std::string out;
+    std::string word;
+    out.reserve(1 << 20);
+
+    for (;;) {
+        std::uint32_t id = 0;
+        if (!readSymbol(words, in, id)) return in.bad() ? UNABLE_TO_OPEN_FILE : CORRUPT_INPUT;
+        if (id == AdaptiveHuffmanModel::kNYT) {
+            // New word: its spelling follows, one byte symbol at a time.
+            word.clear();
+            for (;;) {
+                std::uint32_t c = 0;
+                if (!readSymbol(chars, in, c)) return in.bad() ? UNABLE_TO_OPEN_FILE : CORRUPT_INPUT;
+                if (c == AdaptiveHuffmanModel::kNYT) {
+                    c = 0;
+                    for (int i = 0; i < 9; ++i) {
+                        const int b = in.bit();
+                        if (b < 0) return CORRUPT_INPUT;
+                        c = (c << 1) | static_cast<std::uint32_t>(b);
+                    }
+                    if (c > kEndOfWord || chars.contains(c)) return CORRUPT_INPUT;
+                }
+                chars.update(c);
+                if (c == kEndOfWord) break;
+                word.push_back(static_cast<char>(c));
+            }
+            if (word.empty()) break; // end of stream
+            const std::size_t before = ids.size();
+            id = ids.intern(word);
+            if (ids.size() == before) return CORRUPT_INPUT; // spelled a word it already had
+        }
+        words.update(id);
+
+        out.append(ids.word(id));
+        out.push_back('\n');
+        if (out.size() >= (1u << 20)) {
+            tokens.write(out.data(), static_cast<std::streamsize>(out.size()));
+            out.clear();
+        }
+    }
+    tokens.write(out.data(), static_cast<std::streamsize>(out.size()));
+    if (tokens.fail()) return FAILED_TO_WRITE_FILE;
+    return NO_ERROR;
+}
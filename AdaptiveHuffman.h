@@ -0,0 +1,138 @@
+//
+// AdaptiveHuffman.h
+//
+// Single-pass adaptive Huffman coding (FGK) over word symbols, for streams that
+// cannot be read twice. Encoder and decoder start from the same empty tree and
+// apply the same update after every token, so no counts and no .hdr are needed:
+// the first code bits go out with the first token.
+//
+// - Word model: one leaf per word seen so far plus an NYT ("not yet transmitted")
+//   leaf. Words are numbered in first-seen order, like SymbolTable.
+// - A new word is sent as the NYT code followed by its spelling in a second
+//   adaptive model over bytes (256 = end of word). A byte that model has not seen
+//   yet is its NYT code plus 9 raw bits.
+// - End of stream: the word NYT followed by an empty spelling (no token is empty).
+//
+// Stream layout: magic "HUFD", then the bits MSB first, last byte zero-padded.
+//
+// Updates keep the FGK sibling property. Nodes are kept in order of non-increasing
+// weight, and before a node's weight goes up it swaps with the first node of equal
+// weight. Nodes of one weight form a block (a run of ranks) that records where it
+// starts, so that lookup is O(1) and an update costs O(code length). The NYT keeps
+// weight 1 and every token adds 2 to its word (two unit steps). With no zero
+// weights a parent always outweighs its children, so the swap never needs FGK's
+// special case for the NYT's sibling.
+//
+
+#ifndef IMPLEMENTATION_ADAPTIVEHUFFMAN_H
+#define IMPLEMENTATION_ADAPTIVEHUFFMAN_H
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string_view>
+#include <vector>
+#include "SymbolTable.h"
+#include "utils.hpp"
+
+// The adaptive tree shared by encoder and decoder. Symbols are dense IDs 0, 1, 2, ...
+class AdaptiveHuffmanModel {
+public:
+    static constexpr std::uint32_t kNYT = UINT32_MAX;  // symbol of the escape leaf
+    static constexpr std::uint32_t kNone = UINT32_MAX;
+
+    AdaptiveHuffmanModel();
+
+    [[nodiscard]] bool contains(std::uint32_t symbol) const noexcept {
+        return symbol < leafOf_.size() && leafOf_[symbol] != kNone;
+    }
+
+    // Code of 'symbol' (or kNYT) as bits from the leaf up to the root; send them in reverse.
+    void path(std::uint32_t symbol, std::vector<unsigned char>& bits) const;
+
+    // Count one more 'symbol'; a symbol not contained yet gets a leaf split off the NYT.
+    void update(std::uint32_t symbol);
+
+    // Decoder walk: start at root(), follow child() per bit until isLeaf().
+    [[nodiscard]] std::uint32_t root() const noexcept { return root_; }
+    [[nodiscard]] bool isLeaf(std::uint32_t n) const noexcept { return nodes_[n].child[0] == kNone; }
+    [[nodiscard]] std::uint32_t child(std::uint32_t n, unsigned bit) const noexcept { return nodes_[n].child[bit]; }
+    [[nodiscard]] std::uint32_t symbol(std::uint32_t n) const noexcept { return nodes_[n].symbol; }
+
+private:
+    struct Node {
+        std::uint64_t weight = 0;
+        std::uint32_t parent = kNone;
+        std::uint32_t child[2] = {kNone, kNone};
+        std::uint32_t symbol = kNYT; // leaves only
+        std::uint32_t rank = 0;      // index in order_
+        std::uint32_t block = 0;     // index in first_: the run of nodes with this weight
+    };
+
+    std::vector<Node> nodes_;
+    std::vector<std::uint32_t> order_;      // rank -> node; weights never increase along it
+    std::vector<std::uint32_t> leafOf_;     // symbol -> leaf node
+    std::vector<std::uint32_t> first_;      // block -> its lowest rank
+    std::vector<std::uint32_t> freeBlocks_; // emptied blocks, reused
+    std::uint32_t root_ = 0;
+    std::uint32_t nyt_ = 0;
+
+    void climb(std::uint32_t n); // add 1 to n and every ancestor
+    void increment(std::uint32_t n);
+    void swapNodes(std::uint32_t a, std::uint32_t b);
+};
+
+class AdaptiveHuffmanEncoder {
+public:
+    static constexpr std::string_view kMagic = "HUFD";
+
+    // Writes the magic straight away.
+    explicit AdaptiveHuffmanEncoder(std::ostream& os);
+
+    // Non-copyable: it owns a position in 'os'.
+    AdaptiveHuffmanEncoder(const AdaptiveHuffmanEncoder&) = delete;
+    AdaptiveHuffmanEncoder& operator=(const AdaptiveHuffmanEncoder&) = delete;
+
+    error_type put(std::string_view word); // append one (non-empty) token
+    error_type flush();  // hand every whole byte so far to the stream and flush it
+    error_type finish(); // end-of-stream marker, pad, flush
+
+private:
+    static constexpr std::size_t kBufferBytes = 64 * 1024;
+    static constexpr std::uint32_t kEndOfWord = 256;
+
+    std::ostream& os_;
+    AdaptiveHuffmanModel words_;
+    AdaptiveHuffmanModel chars_;
+    SymbolTable ids_;
+    std::vector<unsigned char> path_;
+    std::vector<char> buf_;
+    unsigned acc_ = 0;  // pending bits, right-aligned
+    unsigned used_ = 0; // < 8
+
+    void putBit(unsigned bit) {
+        acc_ = (acc_ << 1) | bit;
+        if (++used_ == 8) {
+            buf_.push_back(static_cast<char>(acc_));
+            acc_ = 0;
+            used_ = 0;
+        }
+    }
+    void putCode(const AdaptiveHuffmanModel& model, std::uint32_t symbol);
+    void spell(std::string_view word);
+    void putChar(std::uint32_t c);
+    void drain();
+};
+
+class AdaptiveHuffmanDecoder {
+public:
+    static constexpr std::string_view kMagic = AdaptiveHuffmanEncoder::kMagic;
+
+    // Decode a whole adaptive stream, writing one word per line (the .tokens format).
+    // CORRUPT_INPUT on a bad magic, an impossible code, or a missing end marker.
+    static error_type decode(std::istream& code, std::ostream& tokens);
+};
+
+#endif //IMPLEMENTATION_ADAPTIVEHUFFMAN_H
@@ -30,21 +30,14 @@
 #include <optional>
 #include <utility>
 #include <vector>
+#include <cstdint>
 #include "TreeNode.h"
 
 // ===============================
 //  Public API
 // ===============================
 
-BST::~BST() {
-    // Expectation:
-    // - Recursively delete every node in the tree to avoid leaks.
-    // - Safe on empty trees (root_ == nullptr).
-    destroy(root_);
-    root_ = nullptr;
-}
-
-void BST::insert(const std::string& word) {
+void BST::insert(std::string_view word) {
     // Expected behavior (spec):
     // - If 'word' already exists, increment its count and do NOT create a new node.
     // - Otherwise, create a new node with count = 1 at the correct BST position.
@@ -52,7 +45,15 @@ void BST::insert(const std::string& word) {
     //
     // Complexity:
     // - Average O(log V) with randomized insertion order; worst-case O(V) when skewed.
-    root_ = insertHelper(root_, word);
+    insertHelper(word, 1);
+}
+
+void BST::insert(std::string_view word, size_t count) {
+    // Same as insert(word) repeated 'count' times, in one descent.
+    // Used when tokens were already counted elsewhere (e.g. on interned symbol IDs):
+    // inserting each distinct word once, in first-seen order, builds exactly the tree
+    // the token-by-token inserts would have built.
+    insertHelper(word, count);
 }
 
 void BST::bulkInsert(const std::vector<std::string>& words) {
@@ -66,18 +67,25 @@ void BST::bulkInsert(const std::vector<std::string>& words) {
     }
 }
 
+void BST::bulkInsert(const std::vector<std::string_view>& words) {
+    // Same as above for views produced by Scanner::tokenizeMapped().
+    for (const auto w : words) {
+        insert(w);
+    }
+}
+
 bool BST::contains(std::string_view w) const noexcept {
     // Return true if the word exists in the BST; otherwise false.
     // No side effects.
-    return findNode(root_, w) != nullptr;
+    return findNode(w) != TreeNode::kNoNode;
 }
 
 std::optional<size_t> BST::countOf(std::string_view w) const noexcept {
     // Return the frequency (count) for a word if present; otherwise std::nullopt.
     // No side effects.
-    const TreeNode* n = findNode(root_, w);
-    if (!n) return std::nullopt;
-    return n->count;
+    const std::uint32_t i = findNode(w);
+    if (i == TreeNode::kNoNode) return std::nullopt;
+    return nodes_[i].count;
 }
 
 void BST::inorderCollect(std::vector<std::pair<std::string, size_t>>& out) const {
@@ -87,91 +95,98 @@ void BST::inorderCollect(std::vector<std::pair<std::string, size_t>>& out) const
     // Contract:
     // - 'out' is appended to (caller may pass an existing vector); clear it beforehand
     //   in the caller if you need a fresh list.
-    inorderHelper(root_, out);
+    //
+    // Iterative with an explicit stack: an unbalanced BST over sorted input is as
+    // deep as it is large, which would overflow the call stack if done recursively.
+    out.reserve(out.size() + nodes_.size());
+    std::vector<std::uint32_t> stack;
+    std::uint32_t i = root_;
+    while (i != TreeNode::kNoNode || !stack.empty()) {
+        while (i != TreeNode::kNoNode) {
+            stack.push_back(i);
+            i = nodes_[i].left;
+        }
+        const TreeNode& n = nodes_[stack.back()];
+        stack.pop_back();
+        out.emplace_back(wordOf(n), n.count);
+        i = n.right;
+    }
 }
 
 size_t BST::size() const noexcept {
     // Return the number of distinct words (i.e., number of nodes).
-    return sizeHelper(root_);
+    // Every node is an entry of nodes_, so its length is the answer in O(1).
+    return nodes_.size();
 }
 
 unsigned BST::height() const noexcept {
     // Return:
     // - 0 if the tree is empty (spec requirement for Part 2).
     // - Otherwise 1 + max(height(left), height(right)).
-    return heightHelper(root_);
+    //
+    // Iterative depth-first walk carrying each node's depth (see inorderCollect on
+    // why not recursion).
+    unsigned best = 0;
+    std::vector<std::pair<std::uint32_t, unsigned>> stack;
+    if (root_ != TreeNode::kNoNode) stack.emplace_back(root_, 1u);
+    while (!stack.empty()) {
+        const auto [i, depth] = stack.back();
+        stack.pop_back();
+        if (depth > best) best = depth;
+        const TreeNode& n = nodes_[i];
+        if (n.left != TreeNode::kNoNode)  stack.emplace_back(n.left, depth + 1);
+        if (n.right != TreeNode::kNoNode) stack.emplace_back(n.right, depth + 1);
+    }
+    return best;
 }
 
 // ===============================
 //  Private helpers
 // ===============================
 
-void BST::destroy(TreeNode* n) noexcept {
-    // Recursively delete the entire subtree rooted at n.
-    // Safe on nullptr.
-    if (!n) return;
-    destroy(n->left);
-    destroy(n->right);
-    delete n;
-}
-
-TreeNode* BST::insertHelper(TreeNode* n, const std::string& w) {
-    // Standard BST insert on key 'w':
-    // - If n is nullptr: create Node(w) with count=1 and return it.
-    // - If w == n->word: ++n->count and return n.
-    // - If w <  n->word: n->left  = insertHelper(n->left, w);  return n.
-    // - If w >  n->word: n->right = insertHelper(n->right, w); return n.
+void BST::insertHelper(std::string_view w, size_t count) {
+    // Standard BST insert on key 'w', done iteratively on node indices:
+    // - Walk down from the root: w == word -> count += count and stop;
+    //   w < word -> go left; w > word -> go right.
+    // - Falling off the tree: append Node(w) with the given count and hook it onto
+    //   the parent's left or right index.
     //
     // Tie-breaking:
     // - Exact string equality is the only case that increments.
     // - No balancing/rotations in this assignment.
     //
-    if (!n) return new TreeNode(w);
-    if (w == n->word) {
-        ++n->count;
-        return n;
+    // Note: nodes_.push_back may reallocate, so we remember the parent by index and
+    // side rather than holding a reference across the append.
+    std::uint32_t parent = TreeNode::kNoNode;
+    bool goLeft = false;
+    for (std::uint32_t i = root_; i != TreeNode::kNoNode;) {
+        TreeNode& n = nodes_[i];
+        const std::string_view nw = wordOf(n);
+        if (w == nw) {
+            n.count += count;
+            return;
+        }
+        parent = i;
+        goLeft = w < nw;
+        i = goLeft ? n.left : n.right;
     }
-    if (w < n->word) {
-        n->left = insertHelper(n->left, w);
-    } else {
-        n->right = insertHelper(n->right, w);
-    }
-    return n;
-}
 
-const TreeNode* BST::findNode(const TreeNode* n, std::string_view w) noexcept {
-    // Iterative or recursive lookup:
-    // - Follow BST ordering until matching node or nullptr.
-    while (n) {
-        if (w == n->word) return n;
-        if (w < n->word)  n = n->left;
-        else              n = n->right;
-    }
-    return nullptr;
+    const auto id = static_cast<std::uint32_t>(nodes_.size());
+    nodes_.emplace_back(words_.add(w), count);
+    if (parent == TreeNode::kNoNode) root_ = id;
+    else if (goLeft)                 nodes_[parent].left = id;
+    else                             nodes_[parent].right = id;
 }
 
-void BST::inorderHelper(const TreeNode* n,
-                        std::vector<std::pair<std::string, size_t>>& out) {
-    // In-order traversal:
-    // - Visit left, then node, then right.
-    // - Push back (word, count) pairs in that order.
-    if (!n) return;
-    inorderHelper(n->left, out);
-    out.emplace_back(n->word, n->count);
-    inorderHelper(n->right, out);
-}
-
-size_t BST::sizeHelper(const TreeNode* n) noexcept {
-    // Return number of nodes in subtree.
-    if (!n) return 0;
-    return 1 + sizeHelper(n->left) + sizeHelper(n->right);
-}
-
-unsigned BST::heightHelper(const TreeNode* n) noexcept {
-    // Empty subtree height = 0 (per Part 2 spec).
-    // Non-empty: 1 + max(h(left), h(right)).
-    if (!n) return 0;
-    unsigned hl = heightHelper(n->left);
-    unsigned hr = heightHelper(n->right);
-    return 1 + (hl > hr ? hl : hr);
+std::uint32_t BST::findNode(std::string_view w) const noexcept {
+    // Iterative lookup:
+    // - Follow BST ordering until matching node or kNoNode.
+    std::uint32_t i = root_;
+    while (i != TreeNode::kNoNode) {
+        const TreeNode& n = nodes_[i];
+        const std::string_view nw = wordOf(n);
+        if (w == nw) return i;
+        i = (w < nw) ? n.left : n.right;
+    }
+    return TreeNode::kNoNode;
 }
@@ -7,37 +7,47 @@
 
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
 #include <optional>
+#include <cstdint>
 #include "TreeNode.h"
+#include "StringPool.h"
+#include "FrequencyCounter.h"
 
-class BST {
+class BST : public FrequencyCounter {
 public:
     BST() = default; //Constructor
-    ~BST(); //destructor: calls destroy(root_)
+    ~BST() override = default; //destructor: nodes and words live in two flat buffers
 
-    void insert(const std::string& word);             // count++
-    void bulkInsert(const std::vector<std::string>&); // convenience
+    // Owns its nodes: non-copyable.
+    BST(const BST&) = delete;
+    BST& operator=(const BST&) = delete;
+
+    void insert(std::string_view word) override;               // count++
+    void insert(std::string_view word, size_t count) override; // count += count (pre-counted input)
+    void bulkInsert(const std::vector<std::string>&) override; // convenience
+    void bulkInsert(const std::vector<std::string_view>&) override; // zero-copy Scanner tokens
 
     [[nodiscard]] bool contains(std::string_view w) const noexcept;
-    [[nodiscard]] std::optional<size_t> countOf(std::string_view w) const noexcept;
+    [[nodiscard]] std::optional<size_t> countOf(std::string_view w) const noexcept override;
 
     // In-order lexicographic (word asc) → flat (word, count)
-    void inorderCollect(std::vector<std::pair<std::string,size_t>>& out) const;
+    void inorderCollect(std::vector<std::pair<std::string,size_t>>& out) const override;
 
-    [[nodiscard]] size_t size() const noexcept;   // distinct words
-    [[nodiscard]] unsigned height() const noexcept; // empty = 0
+    [[nodiscard]] size_t size() const noexcept override;   // distinct words
+    [[nodiscard]] unsigned height() const noexcept override; // empty = 0
 
 private:
 
-    TreeNode* root_ = nullptr;
+    // Nodes live in one vector and link to each other by index; words live in one pool.
+    std::vector<TreeNode> nodes_;
+    StringPool words_;
+    std::uint32_t root_ = TreeNode::kNoNode;
 
-    static void destroy(TreeNode* n) noexcept;
-    static TreeNode* insertHelper(TreeNode* n, const std::string& w);
-    static const TreeNode* findNode(const TreeNode* n, std::string_view w) noexcept;
-    static void inorderHelper(const TreeNode* n, std::vector<std::pair<std::string,size_t>>& out);
-    static size_t sizeHelper(const TreeNode* n) noexcept;
-    static unsigned heightHelper(const TreeNode* n) noexcept;
+    void insertHelper(std::string_view w, size_t count);
+    std::uint32_t findNode(std::string_view w) const noexcept; // kNoNode if absent
+    std::string_view wordOf(const TreeNode& n) const noexcept { return words_.view(n.word); }
 };
 
 #endif //IMPLEMENTATION_BST_H
\ No newline at end of file
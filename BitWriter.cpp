@@ -0,0 +1,60 @@
+//
+// BitWriter.cpp
+//
+
+#include "BitWriter.h"
+
+BitWriter::BitWriter(std::ostream& os) : os_(os), headerPos_(os.tellp()) {
+    buf_.reserve(kBufferBytes + 8);
+    os_.write(kMagic.data(), static_cast<std::streamsize>(kMagic.size()));
+    const char zeros[8] = {};
+    os_.write(zeros, sizeof zeros); // bit count, patched by finish()
+}
+
+void BitWriter::putSlow(std::uint64_t bits, unsigned len) {
+    // The accumulator fills up: top it off to exactly 64 bits, ship that word, and
+    // keep the leftover low bits of 'bits'.
+    const unsigned fill = 64 - used_;  // 1..64 bits still fit
+    const unsigned rest = len - fill;  // 0..63 bits left over
+    const std::uint64_t head = fill == 64 ? 0 : acc_ << fill;
+    pushWord(head | (bits >> rest));
+    acc_ = rest == 0 ? 0 : bits & ((std::uint64_t{1} << rest) - 1);
+    used_ = rest;
+}
+
+void BitWriter::pushWord(std::uint64_t word) {
+    // Big-endian, so the first code bit is the top bit of the first byte.
+    for (int shift = 56; shift >= 0; shift -= 8) buf_.push_back(static_cast<char>(word >> shift));
+    flushedBits_ += 64;
+    if (buf_.size() >= kBufferBytes) flushBuffer();
+}
+
+void BitWriter::flushBuffer() {
+    os_.write(buf_.data(), static_cast<std::streamsize>(buf_.size()));
+    buf_.clear();
+}
+
+error_type BitWriter::finish() {
+    // 1) Pending bits, left-aligned and zero-padded to whole bytes.
+    if (used_ != 0) {
+        const std::uint64_t word = acc_ << (64 - used_);
+        const unsigned bytes = (used_ + 7) / 8;
+        for (unsigned i = 0; i < bytes; ++i) buf_.push_back(static_cast<char>(word >> (56 - 8 * i)));
+        flushedBits_ += used_;
+        acc_ = 0;
+        used_ = 0;
+    }
+    flushBuffer();
+
+    // 2) Patch the bit count into the header, then return to the end.
+    if (headerPos_ == std::streampos(-1)) return FAILED_TO_WRITE_FILE;
+    const std::streampos end = os_.tellp();
+    char count[8];
+    for (int i = 0; i < 8; ++i) count[i] = static_cast<char>(flushedBits_ >> (8 * i));
+    os_.seekp(headerPos_ + std::streamoff(kMagic.size()));
+    os_.write(count, sizeof count);
+    os_.seekp(end);
+
+    if (os_.fail()) return FAILED_TO_WRITE_FILE;
+    return NO_ERROR;
+}
@@ -0,0 +1,70 @@
+//
+// BitWriter.h
+//
+// Packs Huffman code bits into bytes for the binary .code format.
+//
+// Binary .code layout:
+//   bytes 0..3   magic "HUFB"
+//   bytes 4..11  total number of code bits, unsigned 64-bit little-endian
+//   bytes 12..   the bits, MSB first within each byte; the last byte is zero-padded
+//
+// Bits collect in a 64-bit accumulator and leave it a whole word at a time into an
+// output buffer, so the per-code cost is a shift and an OR rather than one stream
+// put() per bit. The bit count is only known at the end, so finish() seeks back and
+// patches the header: the stream must be seekable (files are).
+//
+
+#ifndef IMPLEMENTATION_BITWRITER_H
+#define IMPLEMENTATION_BITWRITER_H
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <vector>
+#include "utils.hpp"
+
+class BitWriter {
+public:
+    static constexpr std::string_view kMagic = "HUFB";
+    static constexpr std::size_t kHeaderBytes = 12;
+
+    // Writes a placeholder header at the stream's current position.
+    explicit BitWriter(std::ostream& os);
+
+    // Non-copyable: it owns a position in 'os'.
+    BitWriter(const BitWriter&) = delete;
+    BitWriter& operator=(const BitWriter&) = delete;
+
+    // Append the low 'len' bits of 'bits' (1 <= len <= 64), most significant first.
+    // Bits above 'len' must be zero.
+    void put(std::uint64_t bits, unsigned len) {
+        if (len < 64 - used_) {
+            acc_ = (acc_ << len) | bits;
+            used_ += len;
+            return;
+        }
+        putSlow(bits, len);
+    }
+
+    // Pad, flush, patch the header's bit count. Returns FAILED_TO_WRITE_FILE on a
+    // stream error or an unseekable stream.
+    error_type finish();
+
+private:
+    static constexpr std::size_t kBufferBytes = 64 * 1024;
+
+    std::ostream& os_;
+    std::streampos headerPos_;
+    std::uint64_t acc_ = 0;       // pending bits, right-aligned
+    unsigned used_ = 0;           // number of pending bits in acc_ (< 64)
+    std::uint64_t flushedBits_ = 0;
+    std::vector<char> buf_;
+
+    void putSlow(std::uint64_t bits, unsigned len);
+    void pushWord(std::uint64_t word);
+    void flushBuffer();
+};
+
+#endif //IMPLEMENTATION_BITWRITER_H
@@ -0,0 +1,118 @@
+//
+// BlockIndex.cpp
+//
+
+#include "BlockIndex.h"
+
+#include <algorithm>
+
+namespace {
+    void putLE(char* out, std::uint64_t v) noexcept {
+        for (int i = 0; i < 8; ++i) out[i] = static_cast<char>(v >> (8 * i));
+    }
+
+    std::uint64_t getLE(const char* in) noexcept {
+        std::uint64_t v = 0;
+        for (int i = 7; i >= 0; --i) v = (v << 8) | static_cast<unsigned char>(in[i]);
+        return v;
+    }
+}
+
+error_type BlockIndex::writeHeader(std::ostream& os) const {
+    const std::string_view magic = adaptive_ ? kAdaptiveMagic : kMagic;
+    char header[kHeaderBytes];
+    std::copy(magic.begin(), magic.end(), header);
+    putLE(header + kMagic.size(), tokensPerBlock_);
+    os.write(header, sizeof header);
+    return os.fail() ? FAILED_TO_WRITE_FILE : NO_ERROR;
+}
+
+void BlockIndex::add(std::uint64_t byteOffset, std::uint64_t bitCount, std::uint64_t tokenCount) {
+    blocks_.push_back({byteOffset, bitCount, tokenCount, this->tokenCount()});
+}
+
+error_type BlockIndex::writeIndex(std::ostream& os, std::uint64_t indexOffset) const {
+    std::vector<char> out(blocks_.size() * kEntryBytes + kTrailerBytes);
+    char* p = out.data();
+    for (const Block& b : blocks_) {
+        putLE(p, b.byteOffset);
+        putLE(p + 8, b.bitCount);
+        putLE(p + 16, b.tokenCount);
+        p += kEntryBytes;
+    }
+    putLE(p, blocks_.size());
+    putLE(p + 8, indexOffset);
+    const std::string_view magic = adaptive_ ? kAdaptiveMagic : kMagic;
+    std::copy(magic.begin(), magic.end(), p + 16);
+    os.write(out.data(), static_cast<std::streamsize>(out.size()));
+    return os.fail() ? FAILED_TO_WRITE_FILE : NO_ERROR;
+}
+
+error_type BlockIndex::read(std::istream& is) {
+    blocks_.clear();
+
+    // Header and trailer.
+    char header[kHeaderBytes];
+    char trailer[kTrailerBytes];
+    is.clear();
+    is.seekg(0, std::ios::end);
+    const std::streamoff fileSize = is.tellg();
+    if (fileSize < static_cast<std::streamoff>(kHeaderBytes + kTrailerBytes)) return CORRUPT_INPUT;
+    is.seekg(0);
+    is.read(header, sizeof header);
+    is.seekg(fileSize - static_cast<std::streamoff>(kTrailerBytes));
+    is.read(trailer, sizeof trailer);
+    if (!is) return UNABLE_TO_OPEN_FILE;
+    const std::string_view magic(header, kMagic.size());
+    if ((magic != kMagic && magic != kAdaptiveMagic) ||
+        std::string_view(trailer + 16, kMagic.size()) != magic) return CORRUPT_INPUT;
+    adaptive_ = magic == kAdaptiveMagic;
+
+    tokensPerBlock_ = getLE(header + kMagic.size());
+    const std::uint64_t count = getLE(trailer);
+    const std::uint64_t indexOffset = getLE(trailer + 8);
+    const auto size = static_cast<std::uint64_t>(fileSize);
+    if (tokensPerBlock_ == 0 || indexOffset < kHeaderBytes ||
+        indexOffset > size - kTrailerBytes ||
+        (size - kTrailerBytes - indexOffset) / kEntryBytes != count ||
+        (size - kTrailerBytes - indexOffset) % kEntryBytes != 0) return CORRUPT_INPUT;
+
+    // Entries: blocks must lie between the header and the index, in order, each
+    // holding at most tokensPerBlock tokens.
+    std::vector<char> raw(count * kEntryBytes);
+    is.seekg(static_cast<std::streamoff>(indexOffset));
+    is.read(raw.data(), static_cast<std::streamsize>(raw.size()));
+    if (!is) return UNABLE_TO_OPEN_FILE;
+
+    blocks_.reserve(count);
+    std::uint64_t end = kHeaderBytes;
+    for (std::uint64_t i = 0; i < count; ++i) {
+        const char* p = raw.data() + i * kEntryBytes;
+        const Block b{getLE(p), getLE(p + 8), getLE(p + 16), tokenCount()};
+        if (b.byteOffset != end || b.tokenCount > tokensPerBlock_ ||
+            b.bitCount > (indexOffset - b.byteOffset) * 8) return CORRUPT_INPUT;
+        end = b.byteOffset + (b.bitCount + 7) / 8;
+        blocks_.push_back(b);
+    }
+    if (end != indexOffset) return CORRUPT_INPUT;
+    return NO_ERROR;
+}
+
+std::size_t BlockIndex::blockOf(std::uint64_t token) const noexcept {
+    // Last block whose first token is <= token.
+    auto it = std::upper_bound(blocks_.begin(), blocks_.end(), token,
+                               [](std::uint64_t t, const Block& b) { return t < b.firstToken; });
+    if (it == blocks_.begin() || token >= tokenCount()) return blocks_.size();
+    return static_cast<std::size_t>(it - blocks_.begin()) - 1;
+}
+
+bool BlockIndex::sniff(std::istream& is) {
+    const std::streampos at = is.tellg();
+    char magic[4] = {};
+    is.read(magic, sizeof magic);
+    const std::string_view seen(magic, static_cast<std::size_t>(is.gcount()));
+    const bool match = seen == kMagic || seen == kAdaptiveMagic;
+    is.clear();
+    is.seekg(at);
+    return match;
+}
@@ -0,0 +1,89 @@
+//
+// BlockIndex.h
+//
+// Block-structured .code container: the token stream is cut into blocks of a fixed
+// number of tokens, each block's bits start on a byte boundary, and a trailing index
+// records where every block is. Blocks decode independently, so a reader can fan
+// them out across threads or jump to token N and decode only the block holding it.
+//
+// Layout (all integers unsigned little-endian):
+//   bytes 0..3   magic "HUFC"
+//   bytes 4..11  tokens per block (every block but the last holds exactly this many)
+//   blocks       each block's code bits, MSB first, last byte zero-padded
+//   index        per block: byte offset in the file, bit count, token count (3 x 64 bits)
+//   trailer      block count (64), byte offset of the index (64), magic "HUFC"
+// The trailer sits at a fixed distance from the end, so the index is found with one
+// seek and no scan; the writer only needs to know offsets after the blocks are out.
+//
+// Adaptive variant (magic "HUFA" in both places, same layout): every block starts
+// with a byte-aligned table saying which code its bits use, and the block's bit
+// count includes that table.
+//   byte 0       0 = the global code from the .hdr; 1 = the block's own code
+//   (own code)   symbol count V (32 bits), then V entries of (.hdr line index (32
+//                bits), code length (8 bits)) in canonical (length, word) order
+// The code bits follow the table.
+//
+
+#ifndef IMPLEMENTATION_BLOCKINDEX_H
+#define IMPLEMENTATION_BLOCKINDEX_H
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string_view>
+#include <vector>
+#include "utils.hpp"
+
+class BlockIndex {
+public:
+    static constexpr std::string_view kMagic = "HUFC";
+    static constexpr std::string_view kAdaptiveMagic = "HUFA";
+    static constexpr std::size_t kHeaderBytes = 12;
+    static constexpr std::size_t kEntryBytes = 24;
+    static constexpr std::size_t kTrailerBytes = 20;
+    static constexpr std::uint64_t kDefaultTokensPerBlock = 64 * 1024;
+
+    struct Block {
+        std::uint64_t byteOffset = 0; // from the start of the file
+        std::uint64_t bitCount = 0;
+        std::uint64_t tokenCount = 0;
+        std::uint64_t firstToken = 0; // not stored: running sum of the token counts
+    };
+
+    BlockIndex() = default;
+    explicit BlockIndex(std::uint64_t tokensPerBlock, bool adaptive = false)
+        : tokensPerBlock_(tokensPerBlock), adaptive_(adaptive) {}
+
+    // Writer side: header first, then one add() per block in order, then the index.
+    error_type writeHeader(std::ostream& os) const;
+    void add(std::uint64_t byteOffset, std::uint64_t bitCount, std::uint64_t tokenCount);
+    error_type writeIndex(std::ostream& os, std::uint64_t indexOffset) const;
+
+    // Reader side: seek to the trailer, load the index, check it against the file size
+    // (clears any eof/fail state first, so a stream that was read to the end works).
+    // CORRUPT_INPUT if the stream is not a well-formed container.
+    error_type read(std::istream& is);
+
+    // Index of the block holding token 'token' (size() if it is past the end).
+    [[nodiscard]] std::size_t blockOf(std::uint64_t token) const noexcept;
+
+    [[nodiscard]] const Block& operator[](std::size_t i) const noexcept { return blocks_[i]; }
+    [[nodiscard]] std::size_t size() const noexcept { return blocks_.size(); }
+    [[nodiscard]] std::uint64_t tokensPerBlock() const noexcept { return tokensPerBlock_; }
+    [[nodiscard]] bool adaptive() const noexcept { return adaptive_; } // per-block code tables
+    [[nodiscard]] std::uint64_t tokenCount() const noexcept {
+        return blocks_.empty() ? 0 : blocks_.back().firstToken + blocks_.back().tokenCount;
+    }
+
+    // True if the stream, from its current position, starts with either magic (position kept).
+    static bool sniff(std::istream& is);
+
+private:
+    std::uint64_t tokensPerBlock_ = kDefaultTokensPerBlock;
+    bool adaptive_ = false;
+    std::vector<Block> blocks_;
+};
+
+#endif //IMPLEMENTATION_BLOCKINDEX_H
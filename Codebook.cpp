@@ -0,0 +1,19 @@
+//
+// Codebook.cpp
+//
+
+#include "Codebook.h"
+
+std::uint32_t Codebook::add(std::string_view word, std::uint64_t bits, unsigned len) {
+    const std::uint32_t id = symbols_.intern(word);
+    if (id == codes_.size()) codes_.push_back(Code{bits, static_cast<std::uint8_t>(len)});
+    else codes_[id] = Code{bits, static_cast<std::uint8_t>(len)}; // re-added word: last code wins
+    return id;
+}
+
+unsigned Codebook::spell(const Code& code, char* out) noexcept {
+    for (unsigned i = 0; i < code.len; ++i) {
+        out[i] = static_cast<char>('0' + ((code.bits >> (code.len - 1 - i)) & 1));
+    }
+    return code.len;
+}
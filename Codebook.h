@@ -0,0 +1,57 @@
+//
+// Codebook.h
+//
+// Flat form of a Huffman code, built once from the tree (HuffmanTree::buildCodebook).
+// The encoders use it:
+// - every code is a (bits, length) pair: the bits are right-aligned in a uint64_t,
+//   and the pairs sit in one contiguous array indexed by symbol ID;
+// - word -> ID goes through a SymbolTable (open addressing, pooled words).
+// Encoding a token is then one hash probe plus an array index, and the bits go into
+// a bit buffer with a shift and an OR. There are no per-token strings.
+//
+// Codes longer than kMaxCodeBits cannot be stored. HuffmanTree never produces them:
+// it caps its code length at kMaxCodeBits.
+//
+
+#ifndef IMPLEMENTATION_CODEBOOK_H
+#define IMPLEMENTATION_CODEBOOK_H
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "SymbolTable.h"
+
+class Codebook {
+public:
+    static constexpr unsigned kMaxCodeBits = 64;
+    static constexpr std::uint32_t kNoSymbol = SymbolTable::kNoSymbol;
+
+    struct Code {
+        std::uint64_t bits = 0; // code bits, right-aligned, first bit most significant
+        std::uint8_t len = 0;   // 1..kMaxCodeBits
+    };
+
+    // Append 'word' with its code; returns its ID (IDs are 0, 1, 2, ... in call order).
+    std::uint32_t add(std::string_view word, std::uint64_t bits, unsigned len);
+
+    // ID of 'word', or kNoSymbol if the code has no such word.
+    [[nodiscard]] std::uint32_t find(std::string_view word) const noexcept { return symbols_.find(word); }
+
+    [[nodiscard]] const Code& code(std::uint32_t id) const noexcept { return codes_[id]; }
+    [[nodiscard]] std::string_view word(std::uint32_t id) const noexcept { return symbols_.word(id); }
+    [[nodiscard]] std::size_t size() const noexcept { return codes_.size(); }
+
+    // Per-ID code length, e.g. for an encoded-size estimate.
+    [[nodiscard]] const std::vector<Code>& codes() const noexcept { return codes_; }
+
+    // Spell a code as '0'/'1' characters into 'out' (room for kMaxCodeBits); returns len.
+    static unsigned spell(const Code& code, char* out) noexcept;
+
+private:
+    SymbolTable symbols_;     // word -> ID
+    std::vector<Code> codes_; // ID -> code
+};
+
+#endif //IMPLEMENTATION_CODEBOOK_H
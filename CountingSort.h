@@ -0,0 +1,97 @@
+//
+// CountingSort.h
+//
+// Non-comparison sorts for frequency ordering (.freq, PriorityQueue, Huffman builds).
+//
+// Word counts are Zipfian: most words have a count of 1, 2 or 3, and only a
+// handful are large. So:
+// - counts below kSmallCounts go through one counting-sort pass (one bucket per count);
+// - the few larger counts get an LSD radix sort, one byte per pass, and only as many
+//   passes as the largest count needs.
+// Both passes are stable, so ties keep their input order. If the input is already in
+// lexicographic (key) order, as inorderCollect produces, the result is exactly the
+// (count desc, key asc) order the comparison sort gave, with no key comparisons at all.
+//
+
+#ifndef IMPLEMENTATION_COUNTINGSORT_H
+#define IMPLEMENTATION_COUNTINGSORT_H
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace counting_sort {
+
+    inline constexpr std::size_t kSmallCounts = 1024;
+
+    // Stable LSD radix pass over one byte: the destination for each item comes from
+    // the histogram of byte 'shift' of key(item). descending = larger bytes first.
+    template <typename T, typename KeyFn>
+    void radixPass(std::vector<T>& items, std::vector<T>& scratch, KeyFn& keyOf, unsigned shift, bool descending) {
+        std::array<std::size_t, 256> start{};
+        for (const T& it : items) ++start[(keyOf(it) >> shift) & 0xFF];
+        std::size_t sum = 0;
+        for (std::size_t i = 0; i < 256; ++i) {
+            const std::size_t b = descending ? 255 - i : i;
+            const std::size_t n = start[b];
+            start[b] = sum;
+            sum += n;
+        }
+        scratch.resize(items.size());
+        for (T& it : items) scratch[start[(keyOf(it) >> shift) & 0xFF]++] = std::move(it);
+        items.swap(scratch);
+    }
+
+    // Stable LSD radix sort by an unsigned integer key; passes stop at the highest
+    // non-zero byte of the largest key.
+    template <typename T, typename KeyFn>
+    void radixSort(std::vector<T>& items, KeyFn keyOf, bool descending) {
+        std::uint64_t maxKey = 0;
+        for (const T& it : items) {
+            const std::uint64_t k = keyOf(it);
+            if (k > maxKey) maxKey = k;
+        }
+        std::vector<T> scratch;
+        for (unsigned shift = 0; shift < 64 && (maxKey >> shift) != 0; shift += 8) {
+            radixPass(items, scratch, keyOf, shift, descending);
+        }
+    }
+
+    // Stable sort by count, largest count first. countOf(item) -> std::size_t.
+    template <typename T, typename CountFn>
+    void sortByCountDesc(std::vector<T>& items, CountFn countOf) {
+        // Split off the (few) large counts, keeping input order in both groups.
+        std::array<std::size_t, kSmallCounts> start{};
+        std::vector<T> large;
+        for (const T& it : items) {
+            const std::size_t c = countOf(it);
+            if (c < kSmallCounts) ++start[c];
+            else large.push_back(it);
+        }
+
+        // Large counts: radix sort, descending.
+        radixSort(large, countOf, true);
+
+        // Small counts: bucket offsets from the top count down, after the large group.
+        std::size_t sum = large.size();
+        for (std::size_t c = kSmallCounts; c-- > 0;) {
+            const std::size_t n = start[c];
+            start[c] = sum;
+            sum += n;
+        }
+
+        std::vector<T> out(items.size());
+        std::move(large.begin(), large.end(), out.begin());
+        for (T& it : items) {
+            const std::size_t c = countOf(it);
+            if (c < kSmallCounts) out[start[c]++] = std::move(it);
+        }
+        items.swap(out);
+    }
+
+} // namespace counting_sort
+
+#endif //IMPLEMENTATION_COUNTINGSORT_H
@@ -0,0 +1,249 @@
+//
+// Dictionary.cpp
+//
+
+#include "Dictionary.h"
+
+#include <algorithm>
+
+namespace {
+    // Canonical codes handed out in code order: the previous code plus one, shifted
+    // left to the new length.
+    class CanonicalCodes {
+    public:
+        // False if the lengths go down, leave 1..kMaxCodeBits, or run out of codes.
+        bool next(unsigned len, Codebook::Code& code) {
+            if (len == 0 || len > Codebook::kMaxCodeBits || len < len_) return false;
+            if (len_ != 0) {
+                ++bits_;
+                if (len_ < 64 ? (bits_ >> len_) != 0 : bits_ == 0) return false;
+                bits_ <<= len - len_;
+            }
+            len_ = len;
+            code = {bits_, static_cast<std::uint8_t>(len)};
+            return true;
+        }
+
+    private:
+        std::uint64_t bits_ = 0;
+        unsigned len_ = 0; // 0 = no code yet
+    };
+
+    // Decimal number up to 'max'.
+    bool parseNumber(std::string_view s, unsigned max, unsigned& out) {
+        if (s.empty()) return false;
+        out = 0;
+        for (const char c : s) {
+            if (c < '0' || c > '9') return false;
+            out = out * 10 + static_cast<unsigned>(c - '0');
+            if (out > max) return false;
+        }
+        return true;
+    }
+
+    // Code length per name from a Huffman tree over 'counts'.
+    std::vector<unsigned> codeLengths(const std::vector<std::pair<std::string, std::size_t>>& counts,
+                                      HuffmanTree::BuildMethod method) {
+        const HuffmanTree tree = HuffmanTree::buildFromCounts(counts, method);
+        const auto book = tree.codebook();
+        std::vector<unsigned> lengths;
+        lengths.reserve(counts.size());
+        for (const auto& [w, c] : counts) lengths.push_back(book->code(book->find(w)).len);
+        return lengths;
+    }
+}
+
+Dictionary Dictionary::train(const std::vector<std::pair<std::string, std::size_t>>& counts,
+                             HuffmanTree::BuildMethod method) {
+    // Words: the escape ("", which sorts first) weighted by the words seen only once.
+    std::size_t once = 0;
+    for (const auto& [w, c] : counts) once += c == 1;
+    std::vector<std::pair<std::string, std::size_t>> wordCounts;
+    wordCounts.reserve(counts.size() + 1);
+    wordCounts.emplace_back(std::string(), std::max<std::size_t>(1, once));
+    wordCounts.insert(wordCounts.end(), counts.begin(), counts.end());
+
+    // Characters: each vocabulary word spelled once, plus one of every byte. End of
+    // word is named "" and the bytes are one-character strings, so the list is still
+    // word-ascending.
+    std::array<std::size_t, kEndOfWord + 1> n{};
+    n.fill(1);
+    n[kEndOfWord] += counts.size();
+    for (const auto& [w, c] : counts) {
+        for (const unsigned char b : w) ++n[b];
+    }
+    std::vector<std::pair<std::string, std::size_t>> charCounts;
+    charCounts.reserve(kEndOfWord + 1);
+    charCounts.emplace_back(std::string(), n[kEndOfWord]);
+    for (unsigned b = 0; b < kEndOfWord; ++b) charCounts.emplace_back(std::string(1, static_cast<char>(b)), n[b]);
+
+    const std::vector<unsigned> wordLengths = codeLengths(wordCounts, method);
+    const std::vector<unsigned> charLengths = codeLengths(charCounts, method);
+
+    std::vector<std::pair<std::string, unsigned>> words;
+    words.reserve(wordCounts.size());
+    for (std::size_t i = 0; i < wordCounts.size(); ++i) words.emplace_back(wordCounts[i].first, wordLengths[i]);
+    std::vector<std::pair<std::uint32_t, unsigned>> chars;
+    chars.reserve(kEndOfWord + 1);
+    chars.emplace_back(kEndOfWord, charLengths[0]);
+    for (std::uint32_t b = 0; b < kEndOfWord; ++b) chars.emplace_back(b, charLengths[b + 1]);
+
+    // Lengths of a Huffman tree (at most Codebook::kMaxCodeBits) always form a code.
+    Dictionary dict;
+    dict.assign(std::move(words), std::move(chars));
+    return dict;
+}
+
+error_type Dictionary::assign(std::vector<std::pair<std::string, unsigned>> words,
+                              std::vector<std::pair<std::uint32_t, unsigned>> chars) {
+    words_.reset();
+    escape_ = Codebook::kNoSymbol;
+
+    std::sort(words.begin(), words.end(), [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second < b.second : a.first < b.first;
+    });
+    std::sort(chars.begin(), chars.end(), [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second < b.second : a.first < b.first;
+    });
+
+    auto book = std::make_shared<Codebook>();
+    std::vector<std::pair<std::uint32_t, unsigned>> order; // (word ID, length) in code order
+    order.reserve(words.size());
+    CanonicalCodes wordCodes;
+    for (const auto& [w, len] : words) {
+        Codebook::Code code;
+        if (!wordCodes.next(len, code)) return CORRUPT_INPUT;
+        const std::size_t before = book->size();
+        const std::uint32_t id = book->add(w, code.bits, len);
+        if (book->size() == before) return CORRUPT_INPUT; // listed twice
+        order.emplace_back(id, len);
+    }
+    const std::uint32_t escape = book->find("");
+    if (escape == Codebook::kNoSymbol) return CORRUPT_INPUT;
+    if (wordTable_.loadCanonical(order) != NO_ERROR) return CORRUPT_INPUT;
+
+    if (chars.size() != kEndOfWord + 1) return CORRUPT_INPUT;
+    std::array<bool, kEndOfWord + 1> seen{};
+    CanonicalCodes charCodes;
+    for (const auto& [c, len] : chars) {
+        if (c > kEndOfWord || seen[c]) return CORRUPT_INPUT;
+        seen[c] = true;
+        if (!charCodes.next(len, chars_[c])) return CORRUPT_INPUT;
+    }
+    if (charTable_.loadCanonical(chars) != NO_ERROR) return CORRUPT_INPUT;
+
+    words_ = std::move(book);
+    escape_ = escape;
+    return NO_ERROR;
+}
+
+error_type Dictionary::load(std::istream& is) {
+    words_.reset();
+    escape_ = Codebook::kNoSymbol;
+
+    std::string line;
+    if (!std::getline(is, line) || line != kMagic) return is.bad() ? UNABLE_TO_OPEN_FILE : CORRUPT_INPUT;
+
+    std::vector<std::pair<std::string, unsigned>> words;
+    std::vector<std::pair<std::uint32_t, unsigned>> chars;
+    bool inChars = false;
+    while (std::getline(is, line)) {
+        if (line.empty()) continue;
+        if (!inChars && line == "#chars") {
+            inChars = true;
+            continue;
+        }
+        const std::size_t space = line.find(' ');
+        if (space == std::string::npos || space == 0) return CORRUPT_INPUT;
+        const std::string_view name(line.data(), space);
+        unsigned len = 0;
+        if (!parseNumber(std::string_view(line).substr(space + 1), Codebook::kMaxCodeBits, len)) return CORRUPT_INPUT;
+
+        if (inChars) {
+            unsigned c = 0;
+            if (!parseNumber(name, kEndOfWord, c)) return CORRUPT_INPUT;
+            chars.emplace_back(c, len);
+        } else {
+            words.emplace_back(name == "#escape" ? std::string() : std::string(name), len);
+        }
+    }
+    if (is.bad()) return UNABLE_TO_OPEN_FILE;
+    if (!inChars) return CORRUPT_INPUT;
+    return assign(std::move(words), std::move(chars));
+}
+
+error_type Dictionary::save(std::ostream& os) const {
+    if (!words_) return FAILED_TO_WRITE_FILE;
+    os << kMagic << '\n';
+    for (std::uint32_t id = 0; id < words_->size(); ++id) {
+        if (id == escape_) os << "#escape";
+        else os << words_->word(id);
+        os << ' ' << static_cast<unsigned>(words_->code(id).len) << '\n';
+    }
+
+    os << "#chars\n";
+    std::vector<std::uint32_t> order(kEndOfWord + 1);
+    for (std::uint32_t c = 0; c <= kEndOfWord; ++c) order[c] = c;
+    std::sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) {
+        return chars_[a].len != chars_[b].len ? chars_[a].len < chars_[b].len : a < b;
+    });
+    for (const std::uint32_t c : order) os << c << ' ' << static_cast<unsigned>(chars_[c].len) << '\n';
+    return os.fail() ? FAILED_TO_WRITE_FILE : NO_ERROR;
+}
+
+Dictionary::Encoder::Encoder(const Dictionary& dict, std::ostream& os_bits, int wrap_cols,
+                             HuffmanTree::CodeFormat format)
+    : dict_(dict), out_(dict.words_, os_bits, wrap_cols, format) {}
+
+error_type Dictionary::Encoder::put(std::string_view word) {
+    if (!dict_.words_ || word.empty()) return FAILED_TO_WRITE_FILE; // "" names the escape
+    const std::uint32_t id = dict_.words_->find(word);
+    if (id != Codebook::kNoSymbol) {
+        out_.emit(dict_.words_->code(id));
+        return NO_ERROR;
+    }
+    out_.emit(dict_.words_->code(dict_.escape_));
+    for (const unsigned char c : word) out_.emit(dict_.chars_[c]);
+    out_.emit(dict_.chars_[kEndOfWord]);
+    ++escaped_;
+    return NO_ERROR;
+}
+
+error_type Dictionary::Encoder::finish() {
+    return out_.finish();
+}
+
+error_type Dictionary::decode(std::istream& code, std::ostream& tokens) const {
+    std::vector<unsigned char> bytes;
+    std::uint64_t bitCount = 0;
+    if (error_type err = HuffmanDecoder::readCodeBits(code, bytes, bitCount); err != NO_ERROR) return err;
+    const unsigned char* data = bytes.data();
+
+    // Collect output in a buffer and write it in large pieces.
+    std::string out;
+    out.reserve(1 << 20);
+    std::uint64_t pos = 0;
+    std::uint32_t s = 0;
+    while (pos < bitCount) {
+        if (error_type err = wordTable_.decodeSymbol(data, bitCount, pos, s); err != NO_ERROR) return err;
+        if (s != escape_) {
+            out.append(words_->word(s));
+        } else {
+            const std::size_t start = out.size();
+            for (;;) {
+                if (error_type err = charTable_.decodeSymbol(data, bitCount, pos, s); err != NO_ERROR) return err;
+                if (s == kEndOfWord) break;
+                out.push_back(static_cast<char>(s));
+            }
+            if (out.size() == start) return CORRUPT_INPUT; // no token is empty
+        }
+        out.push_back('\n');
+        if (out.size() >= (1u << 20)) {
+            tokens.write(out.data(), static_cast<std::streamsize>(out.size()));
+            out.clear();
+        }
+    }
+    tokens.write(out.data(), static_cast<std::streamsize>(out.size()));
+    if (tokens.fail()) return FAILED_TO_WRITE_FILE;
+    return NO_ERROR;
+}
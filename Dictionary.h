@@ -0,0 +1,98 @@
+//
+// Dictionary.h
+//
+// A pretrained code for encoding many documents. It is trained once on the counts of a
+// sample corpus and saved. Every later document is then encoded against it with no
+// counting, no tree build and no .hdr of its own.
+//
+// - Word code: canonical Huffman over the training vocabulary plus an escape symbol.
+//   The escape is weighted by the number of words seen only once in the sample (the
+//   Good-Turing estimate of how often a new word turns up).
+// - Character code: canonical Huffman over the bytes 0..255 plus an end-of-word
+//   symbol (kEndOfWord). Bytes are counted once per vocabulary word, so the code
+//   follows the spelling of word types rather than running text. Every byte gets at
+//   least one count, so any word can be spelled.
+// - A word in the vocabulary is its code. Any other word is the escape code, then the
+//   character code of each of its bytes, then end of word.
+//
+// .dict file (an extended canonical .hdr; codes follow from the order, see
+// HuffmanTree::canonicalize):
+//   #dictionary
+//   word length      one line per vocabulary word, plus "#escape length", in (length, word) order
+//   #chars
+//   byte length      all 257 symbols (256 = end of word), in (length, byte) order
+//
+// The .code a Dictionary writes is the usual ASCII or binary (HUFB) bitstream. It can
+// only be decoded with the same .dict.
+//
+
+#ifndef IMPLEMENTATION_DICTIONARY_H
+#define IMPLEMENTATION_DICTIONARY_H
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "Codebook.h"
+#include "HuffmanDecoder.h"
+#include "HuffmanTree.h"
+#include "utils.hpp"
+
+class Dictionary {
+public:
+    static constexpr std::uint32_t kEndOfWord = 256; // character symbols: bytes, then this
+    static constexpr std::string_view kMagic = "#dictionary";
+
+    // Build both codes from a sample's counts (word-ascending, as inorderCollect gives them).
+    static Dictionary train(const std::vector<std::pair<std::string, std::size_t>>& counts,
+                            HuffmanTree::BuildMethod method = HuffmanTree::BuildMethod::Heap);
+
+    // Read or write a .dict. load() rejects a malformed file with CORRUPT_INPUT and
+    // leaves the dictionary empty.
+    error_type load(std::istream& is);
+    error_type save(std::ostream& os) const;
+
+    [[nodiscard]] std::size_t size() const noexcept { return words_ ? words_->size() - 1 : 0; } // vocabulary
+
+    // Encode tokens one at a time, like HuffmanTree::Encoder. The dictionary must
+    // outlive the encoder.
+    class Encoder {
+    public:
+        Encoder(const Dictionary& dict, std::ostream& os_bits, int wrap_cols = 80,
+                HuffmanTree::CodeFormat format = HuffmanTree::CodeFormat::Ascii);
+
+        error_type put(std::string_view word); // append one (non-empty) token
+        error_type finish();                   // final newline (or bit flush) + stream check
+
+        [[nodiscard]] std::size_t escaped() const noexcept { return escaped_; } // spelled-out tokens
+
+    private:
+        const Dictionary& dict_;
+        HuffmanTree::Encoder out_;
+        std::size_t escaped_ = 0;
+    };
+
+    // Decode a .code written against this dictionary, one word per line (the .tokens format).
+    error_type decode(std::istream& code, std::ostream& tokens) const;
+
+private:
+    std::shared_ptr<Codebook> words_;          // ID = position in (length, word) order; escape is ""
+    std::uint32_t escape_ = Codebook::kNoSymbol;
+    std::array<Codebook::Code, kEndOfWord + 1> chars_{};
+    HuffmanDecoder wordTable_;                 // symbols are word IDs
+    HuffmanDecoder charTable_;                 // symbols are bytes / kEndOfWord
+
+    // Assign canonical codes from the lengths (either order) and build the tables.
+    // 'words' names the escape "". CORRUPT_INPUT if either set is not a prefix code.
+    error_type assign(std::vector<std::pair<std::string, unsigned>> words,
+                      std::vector<std::pair<std::uint32_t, unsigned>> chars);
+};
+
+#endif //IMPLEMENTATION_DICTIONARY_H
@@ -0,0 +1,26 @@
+//
+// FrequencyCounter.cpp
+//
+
+#include "FrequencyCounter.h"
+
+#include "AVLTree.h"
+#include "BST.h"
+#include "HashCounter.h"
+#include "TrieCounter.h"
+
+void FrequencyCounter::bulkInsert(const std::vector<std::string>& words) {
+    for (const auto& w : words) insert(w);
+}
+
+void FrequencyCounter::bulkInsert(const std::vector<std::string_view>& words) {
+    for (const auto w : words) insert(w);
+}
+
+std::unique_ptr<FrequencyCounter> makeFrequencyCounter(std::string_view kind) {
+    if (kind == "bst")  return std::make_unique<BST>();
+    if (kind == "avl")  return std::make_unique<AVLTree>();
+    if (kind == "hash") return std::make_unique<HashCounter>();
+    if (kind == "trie") return std::make_unique<TrieCounter>();
+    return nullptr;
+}
@@ -0,0 +1,49 @@
+//
+// FrequencyCounter.h
+//
+// Interface every word-frequency counting backend implements, so the driver can
+// pick one at runtime (--counter=...). The only ordering requirement is at the end:
+// inorderCollect() must return (word, count) pairs in lexicographic word order,
+// which is what the .freq writer and HuffmanTree::buildFromCounts consume.
+//
+// Backends:
+//   "bst"  – BST, the original unbalanced tree
+//   "avl"  – AVLTree, self-balancing, iterative
+//   "hash" – HashCounter, flat open-addressing table + one sort at collect time
+//   "trie" – TrieCounter, radix trie over the Scanner alphabet; sorted by construction
+//
+
+#ifndef IMPLEMENTATION_FREQUENCYCOUNTER_H
+#define IMPLEMENTATION_FREQUENCYCOUNTER_H
+
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+class FrequencyCounter {
+public:
+    virtual ~FrequencyCounter() = default;
+
+    virtual void insert(std::string_view word) = 0;               // count++
+    virtual void insert(std::string_view word, size_t count) = 0; // count += count (pre-counted input)
+    virtual void bulkInsert(const std::vector<std::string>& words);      // loops over insert()
+    virtual void bulkInsert(const std::vector<std::string_view>& words);
+
+    [[nodiscard]] virtual std::optional<size_t> countOf(std::string_view w) const noexcept = 0;
+
+    // (word, count) pairs in lexicographic word order, appended to 'out'.
+    virtual void inorderCollect(std::vector<std::pair<std::string,size_t>>& out) const = 0;
+
+    [[nodiscard]] virtual size_t size() const noexcept = 0;     // distinct words
+    [[nodiscard]] virtual unsigned height() const noexcept = 0; // tree height; 0 for non-tree backends
+};
+
+// Backend by name ("bst", "avl", "hash", "trie"); nullptr for an unknown name.
+std::unique_ptr<FrequencyCounter> makeFrequencyCounter(std::string_view kind);
+
+#endif //IMPLEMENTATION_FREQUENCYCOUNTER_H
@@ -0,0 +1,146 @@
+//
+// HashCounter.cpp
+//
+
+#include "HashCounter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include "WordHash.h"
+
+namespace {
+    constexpr std::size_t kInitialSlots = 1024;
+}
+
+HashCounter::HashCounter() : slots_(kInitialSlots) {}
+
+void HashCounter::insert(std::string_view word) {
+    insert(word, 1);
+}
+
+void HashCounter::insert(std::string_view word, size_t count) {
+    if (count == 0) return; // count 0 marks an empty slot, so never store it
+
+    const std::uint32_t h = wordHash(word);
+    std::size_t mask = slots_.size() - 1;
+    std::size_t i = h & mask;
+    std::size_t dist = 0;
+
+    // 1) Look for the word. Robin Hood ordering lets us stop as soon as we reach a
+    //    slot whose entry is closer to its home than we are to ours.
+    for (;; i = (i + 1) & mask, ++dist) {
+        Slot& s = slots_[i];
+        if (s.count == 0 || probeDistance(s, i) < dist) break;
+        if (s.hash == h && s.len == word.size() && wordOf(s) == word) {
+            s.count += count;
+            return;
+        }
+    }
+
+    // 2) New word: grow first if needed (keeps load <= 7/8), then place it.
+    if (8 * (size_ + 1) > 7 * slots_.size()) {
+        grow();
+        mask = slots_.size() - 1;
+        i = h & mask;
+        dist = 0;
+    }
+
+    Slot entry;
+    entry.hash = h;
+    entry.len = static_cast<std::uint32_t>(word.size());
+    entry.count = count;
+    if (word.size() <= kInlineBytes) {
+        std::memcpy(entry.inl, word.data(), word.size());
+    } else {
+        entry.off = pool_.size();
+        pool_.append(word);
+    }
+    ++size_;
+
+    // 3) Robin Hood placement: walk forward, swapping with any resident entry that
+    //    is closer to its home slot than the entry we are carrying.
+    for (;; i = (i + 1) & mask, ++dist) {
+        Slot& s = slots_[i];
+        if (s.count == 0) {
+            s = entry;
+            return;
+        }
+        const std::size_t resident = probeDistance(s, i);
+        if (resident < dist) {
+            std::swap(s, entry);
+            dist = resident;
+        }
+    }
+}
+
+std::optional<size_t> HashCounter::countOf(std::string_view w) const noexcept {
+    const std::uint32_t h = wordHash(w);
+    const std::size_t mask = slots_.size() - 1;
+    for (std::size_t i = h & mask, dist = 0;; i = (i + 1) & mask, ++dist) {
+        const Slot& s = slots_[i];
+        if (s.count == 0 || probeDistance(s, i) < dist) return std::nullopt;
+        if (s.hash == h && s.len == w.size() && wordOf(s) == w) return s.count;
+    }
+}
+
+void HashCounter::inorderCollect(std::vector<std::pair<std::string, size_t>>& out) const {
+    // The one place order matters: gather live slots and sort them by word once.
+    std::vector<const Slot*> live;
+    live.reserve(size_);
+    for (const Slot& s : slots_) {
+        if (s.count != 0) live.push_back(&s);
+    }
+    std::sort(live.begin(), live.end(), [this](const Slot* a, const Slot* b) {
+        return wordOf(*a) < wordOf(*b);
+    });
+
+    out.reserve(out.size() + live.size());
+    for (const Slot* s : live) out.emplace_back(wordOf(*s), s->count);
+}
+
+size_t HashCounter::size() const noexcept {
+    return size_;
+}
+
+unsigned HashCounter::height() const noexcept {
+    return 0;
+}
+
+// ===============================
+//  Private helpers
+// ===============================
+
+std::string_view HashCounter::wordOf(const Slot& s) const noexcept {
+    if (s.len <= kInlineBytes) return {s.inl, s.len};
+    return {pool_.data() + s.off, s.len};
+}
+
+std::size_t HashCounter::probeDistance(const Slot& s, std::size_t i) const noexcept {
+    // How far slot i is from the entry's home slot (wrapping around the table).
+    return (i - (s.hash & (slots_.size() - 1))) & (slots_.size() - 1);
+}
+
+void HashCounter::grow() {
+    // Double the table and re-place every entry from its stored hash.
+    std::vector<Slot> old(slots_.size() * 2);
+    old.swap(slots_);
+    const std::size_t mask = slots_.size() - 1;
+    for (Slot& entry : old) {
+        if (entry.count == 0) continue;
+        std::size_t i = entry.hash & mask;
+        std::size_t dist = 0;
+        for (;; i = (i + 1) & mask, ++dist) {
+            Slot& s = slots_[i];
+            if (s.count == 0) {
+                s = entry;
+                break;
+            }
+            const std::size_t resident = probeDistance(s, i);
+            if (resident < dist) {
+                std::swap(s, entry);
+                dist = resident;
+            }
+        }
+    }
+}
@@ -0,0 +1,62 @@
+//
+// HashCounter.h
+//
+// Flat open-addressing word counter (Robin Hood linear probing).
+// Counting is O(1) amortized per token; the lexicographic order the rest of the
+// pipeline needs is produced once, by a single sort in inorderCollect().
+//
+// - One 32-byte slot per word: hash, length, count, and the word itself inline when
+//   it fits in 16 bytes (almost every natural-language word). Longer words spill
+//   into a shared character pool, so no slot ever owns a heap allocation.
+// - Robin Hood: on insert, an entry that has probed further than the resident slot's
+//   entry takes its place, which keeps probe lengths short and uniform at high load.
+//
+
+#ifndef IMPLEMENTATION_HASHCOUNTER_H
+#define IMPLEMENTATION_HASHCOUNTER_H
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "FrequencyCounter.h"
+
+class HashCounter : public FrequencyCounter {
+public:
+    HashCounter();
+
+    void insert(std::string_view word) override;
+    void insert(std::string_view word, size_t count) override;
+
+    [[nodiscard]] std::optional<size_t> countOf(std::string_view w) const noexcept override;
+    void inorderCollect(std::vector<std::pair<std::string,size_t>>& out) const override;
+
+    [[nodiscard]] size_t size() const noexcept override;
+    [[nodiscard]] unsigned height() const noexcept override; // always 0: no tree
+
+private:
+    static constexpr std::size_t kInlineBytes = 16;
+
+    struct Slot {
+        std::uint32_t hash = 0;
+        std::uint32_t len = 0;
+        std::uint64_t count = 0; // 0 = empty slot
+        union {
+            char inl[kInlineBytes];  // len <= kInlineBytes
+            std::uint64_t off;       // otherwise: offset into pool_
+        };
+        Slot() : off(0) {}
+    };
+
+    std::vector<Slot> slots_; // power-of-two size
+    std::string pool_;        // spill area for words longer than kInlineBytes
+    std::size_t size_ = 0;
+
+    [[nodiscard]] std::string_view wordOf(const Slot& s) const noexcept;
+    [[nodiscard]] std::size_t probeDistance(const Slot& s, std::size_t i) const noexcept;
+    void grow();
+};
+
+#endif //IMPLEMENTATION_HASHCOUNTER_H
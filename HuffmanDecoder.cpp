@@ -0,0 +1,403 @@
+//
+// HuffmanDecoder.cpp
+//
+
+#include "HuffmanDecoder.h"
+
+#include <algorithm>
+#include <bit>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include "BitWriter.h"
+
+namespace {
+    // 64 bits starting at 'p', first byte in the top bits.
+    inline std::uint64_t load64be(const unsigned char* p) noexcept {
+        std::uint64_t v;
+        std::memcpy(&v, p, sizeof v);
+        if constexpr (std::endian::native == std::endian::little) v = __builtin_bswap64(v);
+        return v;
+    }
+
+    // Slurp the stream in large reads (a char-by-char iterator is several times slower).
+    bool readAll(std::istream& in, std::string& raw) {
+        std::vector<char> chunk(1 << 16);
+        while (in.read(chunk.data(), static_cast<std::streamsize>(chunk.size())) || in.gcount() > 0) {
+            raw.append(chunk.data(), static_cast<std::size_t>(in.gcount()));
+        }
+        return !in.bad();
+    }
+
+    // Canonical code for the next symbol of length 'len', given the previous code
+    // (empty for the first symbol): previous + 1, then shifted left to the new length.
+    // False if the lengths go down or the codes of one length run out.
+    bool nextCanonicalCode(std::string& code, std::size_t len) {
+        if (len == 0 || len < code.size()) return false;
+        if (code.empty()) {
+            code.assign(len, '0');
+            return true;
+        }
+        std::size_t i = code.size();
+        while (i > 0 && code[i - 1] == '1') code[--i] = '0';
+        if (i == 0) return false; // ran out of codes of this length
+        code[i - 1] = '1';
+        code.append(len - code.size(), '0');
+        return true;
+    }
+
+    std::uint32_t getLE32(const unsigned char* p) noexcept {
+        return static_cast<std::uint32_t>(p[0]) | static_cast<std::uint32_t>(p[1]) << 8 |
+               static_cast<std::uint32_t>(p[2]) << 16 | static_cast<std::uint32_t>(p[3]) << 24;
+    }
+}
+
+error_type HuffmanDecoder::loadHeader(std::istream& hdr) {
+    pool_ = StringPool();
+    words_.clear();
+    table_.clear();
+    primaryBits_ = 0;
+
+    std::vector<TrieNode> trie(1);
+    std::string line;
+    bool canonical = false;
+    bool first = true;
+    std::string code;        // canonical: the code being assigned
+
+    while (std::getline(hdr, line)) {
+        if (first && line == "#canonical") {
+            canonical = true;
+            first = false;
+            continue;
+        }
+        first = false;
+        if (line.empty()) continue;
+
+        const std::size_t space = line.find(' ');
+        if (space == std::string::npos || space == 0) return CORRUPT_INPUT;
+        const std::string_view word(line.data(), space);
+        const std::string_view field(line.data() + space + 1, line.size() - space - 1);
+
+        if (canonical) {
+            // "word length": codes are handed out in file order, which is (length, word).
+            std::size_t len = 0;
+            for (char c : field) {
+                if (c < '0' || c > '9') return CORRUPT_INPUT;
+                len = len * 10 + static_cast<std::size_t>(c - '0');
+                if (len > 4096) return CORRUPT_INPUT;
+            }
+            if (!nextCanonicalCode(code, len)) return CORRUPT_INPUT;
+        } else {
+            // "word code"
+            if (field.empty() || field.find_first_not_of("01") != std::string_view::npos) return CORRUPT_INPUT;
+            code.assign(field);
+        }
+
+        const auto symbol = static_cast<std::uint32_t>(words_.size());
+        if (!insertCode(trie, code, symbol)) return CORRUPT_INPUT;
+        words_.push_back(pool_.add(word));
+    }
+    if (hdr.bad()) return UNABLE_TO_OPEN_FILE;
+    if (words_.empty()) return NO_ERROR; // empty header: only an empty .code decodes
+    compile(trie);
+    return NO_ERROR;
+}
+
+error_type HuffmanDecoder::loadCanonical(const std::vector<std::pair<std::uint32_t, unsigned>>& codes) {
+    table_.clear();
+    primaryBits_ = 0;
+    std::vector<TrieNode> trie(1);
+    std::string code;
+    for (const auto& [symbol, len] : codes) {
+        if (len > 4096 || !nextCanonicalCode(code, len)) return CORRUPT_INPUT;
+        if (!insertCode(trie, code, symbol)) return CORRUPT_INPUT;
+    }
+    if (!codes.empty()) compile(trie);
+    return NO_ERROR;
+}
+
+void HuffmanDecoder::compile(const std::vector<TrieNode>& trie) {
+    // Height of every trie node (longest code below it). Children are always created
+    // after their parent, so a reverse sweep sees children first.
+    std::vector<std::uint32_t> height(trie.size(), 0);
+    for (std::size_t n = trie.size(); n-- > 0;) {
+        for (const std::uint32_t c : trie[n].child) {
+            if (c != kNone) height[n] = std::max(height[n], height[c] + 1);
+        }
+    }
+
+    primaryBits_ = std::min<unsigned>(kPrimaryBits, height[0]);
+    buildTable(trie, height, 0);
+}
+
+bool HuffmanDecoder::insertCode(std::vector<TrieNode>& trie, std::string_view code, std::uint32_t symbol) {
+    // Prefix-free check on the way: never pass through or land on another symbol,
+    // and never end on a node that already has children.
+    std::uint32_t n = 0;
+    for (char c : code) {
+        if (trie[n].symbol != kNone) return false;
+        const int bit = c == '1';
+        if (trie[n].child[bit] == kNone) {
+            trie[n].child[bit] = static_cast<std::uint32_t>(trie.size());
+            trie.emplace_back();
+        }
+        n = trie[n].child[bit];
+    }
+    if (trie[n].symbol != kNone || trie[n].child[0] != kNone || trie[n].child[1] != kNone) return false;
+    trie[n].symbol = symbol;
+    return true;
+}
+
+std::uint32_t HuffmanDecoder::buildTable(const std::vector<TrieNode>& trie,
+                                         const std::vector<std::uint32_t>& height, std::uint32_t node) {
+    // One table for the subtree under 'node', indexed by its next 'width' bits.
+    const unsigned width = std::min<unsigned>(kPrimaryBits, height[node]);
+    const auto offset = static_cast<std::uint32_t>(table_.size());
+    table_.resize(table_.size() + (std::size_t{1} << width));
+
+    for (std::uint32_t p = 0; p < (1u << width); ++p) {
+        // Follow the bits of p (MSB first) until a symbol, a missing branch, or the
+        // table width is used up.
+        std::uint32_t n = node;
+        unsigned depth = 0;
+        while (depth < width && trie[n].symbol == kNone) {
+            n = trie[n].child[(p >> (width - 1 - depth)) & 1];
+            ++depth;
+            if (n == kNone) break;
+        }
+
+        Entry e;
+        if (n == kNone) {
+            // bit pattern that no code starts with: stays kInvalid
+        } else if (trie[n].symbol != kNone) {
+            e = {trie[n].symbol, static_cast<std::uint8_t>(depth), kLeaf};
+        } else {
+            const std::uint32_t sub = buildTable(trie, height, n); // may grow table_
+            e = {sub, static_cast<std::uint8_t>(std::min<unsigned>(kPrimaryBits, height[n])), kLink};
+        }
+        table_[offset + p] = e;
+    }
+    return offset;
+}
+
+error_type HuffmanDecoder::decodeSymbol(const unsigned char* data, std::uint64_t bitCount,
+                                        std::uint64_t& pos, std::uint32_t& symbol) const {
+    if (primaryBits_ == 0) return CORRUPT_INPUT; // no codes
+    std::uint32_t offset = 0;
+    unsigned width = primaryBits_;
+    for (;;) {
+        const std::uint64_t window = load64be(data + (pos >> 3)) << (pos & 7);
+        const Entry e = table_[offset + static_cast<std::uint32_t>(window >> (64 - width))];
+        if (e.kind == kLeaf) {
+            if (pos + e.bits > bitCount) return CORRUPT_INPUT; // code runs past the end
+            pos += e.bits;
+            symbol = e.value;
+            return NO_ERROR;
+        }
+        if (e.kind != kLink) return CORRUPT_INPUT;
+        pos += width;
+        if (pos >= bitCount) return CORRUPT_INPUT;
+        offset = e.value;
+        width = e.bits;
+    }
+}
+
+template <typename Emit>
+error_type HuffmanDecoder::decodeBits(const unsigned char* data, std::uint64_t bitCount,
+                                      Emit&& emit) const {
+    std::uint64_t pos = 0;
+    std::uint32_t symbol = 0;
+    while (pos < bitCount) {
+        if (error_type err = decodeSymbol(data, bitCount, pos, symbol); err != NO_ERROR) return err;
+        emit(symbol);
+    }
+    return NO_ERROR;
+}
+
+error_type HuffmanDecoder::decode(std::istream& code, std::vector<std::uint32_t>& symbols,
+                                  unsigned threads) const {
+    if (BlockIndex::sniff(code)) {
+        std::vector<std::vector<std::uint32_t>> blocks;
+        if (error_type err = decodeBlocks(code, threads, blocks); err != NO_ERROR) return err;
+        for (const auto& b : blocks) symbols.insert(symbols.end(), b.begin(), b.end());
+        return NO_ERROR;
+    }
+
+    std::vector<unsigned char> bytes;
+    std::uint64_t bitCount = 0;
+    if (error_type err = readCodeBits(code, bytes, bitCount); err != NO_ERROR) return err;
+    return decodeBits(bytes.data(), bitCount, [&](std::uint32_t s) { symbols.push_back(s); });
+}
+
+error_type HuffmanDecoder::decode(std::istream& code, std::ostream& tokens, unsigned threads) const {
+    // Collect output in a buffer and write it in large pieces.
+    std::string out;
+    out.reserve(1 << 20);
+    auto emit = [&](std::uint32_t s) {
+        out.append(word(s));
+        out.push_back('\n');
+        if (out.size() >= (1u << 20)) {
+            tokens.write(out.data(), static_cast<std::streamsize>(out.size()));
+            out.clear();
+        }
+    };
+
+    error_type err = NO_ERROR;
+    if (BlockIndex::sniff(code)) {
+        std::vector<std::vector<std::uint32_t>> blocks;
+        err = decodeBlocks(code, threads, blocks);
+        for (std::size_t b = 0; err == NO_ERROR && b < blocks.size(); ++b) {
+            for (const std::uint32_t s : blocks[b]) emit(s);
+            blocks[b] = {}; // free as we go
+        }
+    } else {
+        std::vector<unsigned char> bytes;
+        std::uint64_t bitCount = 0;
+        if (err = readCodeBits(code, bytes, bitCount); err != NO_ERROR) return err;
+        err = decodeBits(bytes.data(), bitCount, emit);
+    }
+    tokens.write(out.data(), static_cast<std::streamsize>(out.size()));
+    if (err != NO_ERROR) return err;
+    if (tokens.fail()) return FAILED_TO_WRITE_FILE;
+    return NO_ERROR;
+}
+
+error_type HuffmanDecoder::decodeRange(std::istream& code, std::uint64_t first, std::uint64_t count,
+                                       std::vector<std::uint32_t>& symbols) const {
+    BlockIndex index;
+    if (error_type err = index.read(code); err != NO_ERROR) return err;
+
+    // Read and decode only the blocks that overlap the range, trimming the ends.
+    const std::uint64_t total = index.tokenCount();
+    const std::uint64_t last = first + std::min(count, total - std::min(first, total));
+    std::vector<unsigned char> bytes;
+    std::vector<std::uint32_t> decoded;
+    for (std::size_t b = index.blockOf(first); b < index.size() && index[b].firstToken < last; ++b) {
+        const BlockIndex::Block& block = index[b];
+        bytes.assign((block.bitCount + 7) / 8 + 8, 0); // + room for the last 64-bit window
+        code.seekg(static_cast<std::streamoff>(block.byteOffset));
+        code.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size() - 8));
+        if (!code) return UNABLE_TO_OPEN_FILE;
+
+        decoded.clear();
+        if (error_type err = decodeBlock(bytes.data(), block, index.adaptive(), decoded); err != NO_ERROR) {
+            return err;
+        }
+        const std::uint64_t from = std::max(first, block.firstToken) - block.firstToken;
+        const std::uint64_t to = std::min(last, block.firstToken + block.tokenCount) - block.firstToken;
+        symbols.insert(symbols.end(), decoded.begin() + static_cast<std::ptrdiff_t>(from),
+                       decoded.begin() + static_cast<std::ptrdiff_t>(to));
+    }
+    return NO_ERROR;
+}
+
+error_type HuffmanDecoder::decodeBlocks(std::istream& code, unsigned threads,
+                                        std::vector<std::vector<std::uint32_t>>& blocks) const {
+    BlockIndex index;
+    if (error_type err = index.read(code); err != NO_ERROR) return err;
+
+    // The whole file in memory, plus padding so every 64-bit window stays in bounds.
+    std::string raw;
+    code.clear();
+    code.seekg(0);
+    if (!readAll(code, raw)) return UNABLE_TO_OPEN_FILE;
+    std::vector<unsigned char> bytes(raw.begin(), raw.end());
+    bytes.insert(bytes.end(), 8, 0);
+    raw = {};
+
+    // Workers claim the next undecoded block; each block has its own output vector.
+    blocks.assign(index.size(), {});
+    std::vector<error_type> results(index.size(), NO_ERROR);
+    std::atomic<std::size_t> next{0};
+    auto work = [&]() {
+        for (std::size_t b = next++; b < index.size(); b = next++) {
+            results[b] = decodeBlock(bytes.data() + index[b].byteOffset, index[b], index.adaptive(), blocks[b]);
+        }
+    };
+
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t workers = std::clamp<std::size_t>(index.size(), 1, threads);
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (std::size_t w = 1; w < workers; ++w) pool.emplace_back(work);
+    work(); // the calling thread takes a share too
+    for (auto& t : pool) t.join();
+
+    for (const error_type err : results) {
+        if (err != NO_ERROR) return err;
+    }
+    return NO_ERROR;
+}
+
+error_type HuffmanDecoder::decodeBlock(const unsigned char* data, const BlockIndex::Block& block,
+                                       bool adaptive, std::vector<std::uint32_t>& symbols) const {
+    symbols.reserve(std::min(block.tokenCount, block.bitCount)); // every code is >= 1 bit
+    auto emit = [&](std::uint32_t s) { symbols.push_back(s); };
+
+    error_type err = NO_ERROR;
+    if (!adaptive) {
+        err = decodeBits(data, block.bitCount, emit);
+    } else {
+        // Code table first (see BlockIndex.h): global code, or the block's own.
+        if (block.bitCount < 8 || data[0] > 1) return CORRUPT_INPUT;
+        if (data[0] == 0) {
+            err = decodeBits(data + 1, block.bitCount - 8, emit);
+        } else {
+            if (block.bitCount < 8 * 5) return CORRUPT_INPUT;
+            const std::uint64_t count = getLE32(data + 1);
+            const std::uint64_t tableBytes = 5 + 5 * count;
+            if (count == 0 || 8 * tableBytes > block.bitCount) return CORRUPT_INPUT;
+
+            std::vector<std::pair<std::uint32_t, unsigned>> codes(count);
+            for (std::uint64_t k = 0; k < count; ++k) {
+                const unsigned char* e = data + 5 + 5 * k;
+                codes[k] = {getLE32(e), e[4]};
+                if (codes[k].first >= words_.size()) return CORRUPT_INPUT;
+            }
+            // Its leaves hold .hdr symbols directly, so the output needs no remapping.
+            HuffmanDecoder own;
+            if (error_type e = own.loadCanonical(codes); e != NO_ERROR) return e;
+            err = own.decodeBits(data + tableBytes, block.bitCount - 8 * tableBytes, emit);
+        }
+    }
+    if (err == NO_ERROR && symbols.size() != block.tokenCount) return CORRUPT_INPUT;
+    return err;
+}
+
+error_type HuffmanDecoder::readCodeBits(std::istream& code, std::vector<unsigned char>& bytes,
+                                        std::uint64_t& bitCount) {
+    std::string raw;
+    if (!readAll(code, raw)) return UNABLE_TO_OPEN_FILE;
+    bytes.clear();
+
+    if (raw.size() >= BitWriter::kHeaderBytes && std::string_view(raw).starts_with(BitWriter::kMagic)) {
+        // Binary: "HUFB", 64-bit little-endian bit count, packed bits.
+        bitCount = 0;
+        for (int i = 7; i >= 0; --i) {
+            bitCount = (bitCount << 8) | static_cast<unsigned char>(raw[BitWriter::kMagic.size() + i]);
+        }
+        const std::size_t payload = raw.size() - BitWriter::kHeaderBytes;
+        if (bitCount > static_cast<std::uint64_t>(payload) * 8) return CORRUPT_INPUT;
+        bytes.assign(raw.begin() + BitWriter::kHeaderBytes, raw.end());
+    } else {
+        // ASCII: '0'/'1' characters, line breaks ignored.
+        bytes.reserve(raw.size() / 8 + 1);
+        unsigned char acc = 0;
+        unsigned used = 0;
+        bitCount = 0;
+        for (char c : raw) {
+            if (c == '\n' || c == '\r') continue;
+            if (c != '0' && c != '1') return CORRUPT_INPUT;
+            acc = static_cast<unsigned char>((acc << 1) | (c == '1'));
+            ++bitCount;
+            if (++used == 8) {
+                bytes.push_back(acc);
+                acc = 0;
+                used = 0;
+            }
+        }
+        if (used != 0) bytes.push_back(static_cast<unsigned char>(acc << (8 - used)));
+    }
+    bytes.insert(bytes.end(), 8, 0); // room for the last 64-bit window
+    return NO_ERROR;
+}
@@ -0,0 +1,115 @@
+//
+// HuffmanDecoder.h
+//
+// Table-driven decoder for the files HuffmanTree writes: loads a .hdr (either the
+// pre-order "word code" format or the "#canonical" "word length" format) and turns a
+// .code (ASCII '0'/'1' lines or the binary "HUFB" format) back into tokens.
+//
+// Decoding never walks a tree bit by bit. Codes are compiled into lookup tables:
+// - the primary table is indexed by the next kPrimaryBits bits of input; an entry is
+//   either a symbol plus its code length (consume that many bits) or a link to a
+//   subtable for codes that are longer than the table;
+// - a subtable is indexed by the following bits in the same way, with a width of at
+//   most kPrimaryBits, so any code length decodes in ceil(length / kPrimaryBits) probes.
+// The input is packed into bytes first, and each probe reads a 64-bit big-endian
+// window at the current bit position.
+//
+
+#ifndef IMPLEMENTATION_HUFFMANDECODER_H
+#define IMPLEMENTATION_HUFFMANDECODER_H
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "BlockIndex.h"
+#include "StringPool.h"
+#include "utils.hpp"
+
+class HuffmanDecoder {
+public:
+    static constexpr unsigned kPrimaryBits = 11;
+
+    // Parse a .hdr and build the tables. CORRUPT_INPUT if the header is malformed or
+    // the codes are not prefix-free.
+    error_type loadHeader(std::istream& hdr);
+
+    // Decode a whole .code stream (format detected from its first bytes).
+    // Symbols are indices into the header's word list; see word().
+    // A block container (BlockIndex.h) is decoded on up to 'threads' workers (0 = all
+    // cores), one block at a time each; the other formats are decoded serially.
+    error_type decode(std::istream& code, std::vector<std::uint32_t>& symbols,
+                      unsigned threads = 1) const;
+    // Same, writing one word per line (the .tokens format).
+    error_type decode(std::istream& code, std::ostream& tokens, unsigned threads = 1) const;
+
+    // Random access into a block container: decode tokens [first, first + count),
+    // clipped to the end of the stream. Only the blocks that hold them are read.
+    // CORRUPT_INPUT if 'code' is not a block container. 'code' must be seekable.
+    error_type decodeRange(std::istream& code, std::uint64_t first, std::uint64_t count,
+                           std::vector<std::uint32_t>& symbols) const;
+
+    [[nodiscard]] std::size_t size() const noexcept { return words_.size(); } // distinct words
+    [[nodiscard]] std::string_view word(std::uint32_t symbol) const noexcept {
+        return pool_.view(words_[symbol]);
+    }
+
+    // Tables only, for a canonical code given as (symbol, length) pairs in code order
+    // (lengths never decreasing); word() is left empty. For callers that keep their own
+    // symbol names, such as Dictionary. CORRUPT_INPUT if the lengths do not form a code.
+    error_type loadCanonical(const std::vector<std::pair<std::uint32_t, unsigned>>& codes);
+
+    // Decode the one symbol at bit 'pos' of 'data' and move 'pos' past it, for streams
+    // that mix codes from several tables. 'data' is padded as readCodeBits leaves it.
+    // CORRUPT_INPUT on a pattern no code starts with or a code running past bitCount.
+    error_type decodeSymbol(const unsigned char* data, std::uint64_t bitCount,
+                            std::uint64_t& pos, std::uint32_t& symbol) const;
+
+    // Read a .code stream into packed bytes (MSB first) plus the exact bit count.
+    // The buffer gets 8 zero bytes of padding so 64-bit windows never read past it.
+    static error_type readCodeBits(std::istream& code, std::vector<unsigned char>& bytes,
+                                   std::uint64_t& bitCount);
+
+private:
+    enum : std::uint8_t { kInvalid = 0, kLeaf = 1, kLink = 2 };
+
+    struct Entry {
+        std::uint32_t value = 0; // kLeaf: symbol; kLink: subtable offset in table_
+        std::uint8_t bits = 0;   // kLeaf: code bits consumed here; kLink: subtable width
+        std::uint8_t kind = kInvalid;
+    };
+
+    // Binary trie over the codes, only used while building the tables.
+    struct TrieNode {
+        std::uint32_t child[2] = {kNone, kNone};
+        std::uint32_t symbol = kNone;
+    };
+    static constexpr std::uint32_t kNone = UINT32_MAX;
+
+    StringPool pool_;
+    std::vector<StringPool::Ref> words_;
+    std::vector<Entry> table_;     // primary table at offset 0, subtables after it
+    unsigned primaryBits_ = 0;     // width of the primary table (0 = no symbols)
+
+    void compile(const std::vector<TrieNode>& trie);
+    static bool insertCode(std::vector<TrieNode>& trie, std::string_view code, std::uint32_t symbol);
+    std::uint32_t buildTable(const std::vector<TrieNode>& trie, const std::vector<std::uint32_t>& height,
+                             std::uint32_t node);
+
+    // 'data' must have 8 readable bytes past the last bit (see readCodeBits).
+    template <typename Emit>
+    error_type decodeBits(const unsigned char* data, std::uint64_t bitCount, Emit&& emit) const;
+
+    // Block container: every block's symbols, decoded on up to 'threads' workers.
+    error_type decodeBlocks(std::istream& code, unsigned threads,
+                            std::vector<std::vector<std::uint32_t>>& blocks) const;
+    error_type decodeBlock(const unsigned char* data, const BlockIndex::Block& block, bool adaptive,
+                           std::vector<std::uint32_t>& symbols) const;
+};
+
+#endif //IMPLEMENTATION_HUFFMANDECODER_H
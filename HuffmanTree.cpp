@@ -4,9 +4,85 @@
 
 #include "HuffmanTree.h"
 
-HuffmanTree::~HuffmanTree() {
-    destroy(root_);
-    root_ = nullptr;
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <utility>
+#include "BlockIndex.h"
+#include "CountingSort.h"
+
+namespace {
+    // Below this many tokens per worker, encodeParallel() stops adding threads.
+    constexpr std::size_t kMinTokensPerEncodeThread = 64 * 1024;
+
+    // One worker's share of the binary output: bits [begin, end) of a zeroed byte
+    // buffer, packed MSB first like BitWriter. The first and last byte may also hold a
+    // neighbour's bits, so those two are kept aside and OR-ed in after the join;
+    // every byte in between belongs to this worker alone.
+    class SliceBitWriter {
+    public:
+        SliceBitWriter(unsigned char* out, std::uint64_t begin, std::uint64_t end)
+            : out_(out), byte_(begin / 8), firstByte_(begin / 8), lastByte_((end - 1) / 8),
+              used_(static_cast<unsigned>(begin % 8)) {}
+
+        void put(std::uint64_t bits, unsigned len) {
+            if (len < 64 - used_) {
+                acc_ = (acc_ << len) | bits;
+                used_ += len;
+                return;
+            }
+            const unsigned fill = 64 - used_;
+            const unsigned rest = len - fill;
+            const std::uint64_t head = fill == 64 ? 0 : acc_ << fill;
+            const std::uint64_t word = head | (bits >> rest);
+            for (int shift = 56; shift >= 0; shift -= 8) store(static_cast<unsigned char>(word >> shift));
+            acc_ = rest == 0 ? 0 : bits & ((std::uint64_t{1} << rest) - 1);
+            used_ = rest;
+        }
+
+        void finish() {
+            const std::uint64_t word = used_ == 0 ? 0 : acc_ << (64 - used_);
+            for (unsigned i = 0; i < (used_ + 7) / 8; ++i) store(static_cast<unsigned char>(word >> (56 - 8 * i)));
+            used_ = 0;
+        }
+
+        // OR the shared edge bytes into the buffer (call after every worker is done).
+        void mergeEdges() const {
+            out_[firstByte_] |= first_;
+            if (lastByte_ != firstByte_) out_[lastByte_] |= last_;
+        }
+
+    private:
+        unsigned char* out_;
+        std::uint64_t byte_;              // next byte to store
+        std::uint64_t firstByte_, lastByte_;
+        unsigned char first_ = 0, last_ = 0;
+        std::uint64_t acc_ = 0;           // pending bits, right-aligned (leading pad bits are 0)
+        unsigned used_;
+
+        void store(unsigned char b) {
+            if (byte_ == firstByte_) first_ |= b;
+            else if (byte_ == lastByte_) last_ |= b;
+            else out_[byte_] = b;
+            ++byte_;
+        }
+    };
+}
+
+HuffmanTree::HuffmanTree(HuffmanTree&& other) noexcept
+    : nodes_(std::move(other.nodes_)), words_(std::move(other.words_)),
+      root_(std::exchange(other.root_, TreeNode::kNoNode)),
+      canonical_(std::exchange(other.canonical_, false)), cache_(std::move(other.cache_)) {}
+
+HuffmanTree& HuffmanTree::operator=(HuffmanTree&& other) noexcept {
+    if (this != &other) {
+        nodes_ = std::move(other.nodes_);
+        words_ = std::move(other.words_);
+        root_ = std::exchange(other.root_, TreeNode::kNoNode);
+        canonical_ = std::exchange(other.canonical_, false);
+        cache_ = std::move(other.cache_);
+    }
+    return *this;
 }
 
 unsigned HuffmanTree::height() const noexcept {
@@ -14,143 +90,712 @@ unsigned HuffmanTree::height() const noexcept {
 }
 
 
-unsigned HuffmanTree::heightHelper(const TreeNode* n) noexcept {
+unsigned HuffmanTree::heightHelper(std::uint32_t n) const noexcept {
 
-    if (!n)
+    if (n == TreeNode::kNoNode)
         return 0; // empty tree = 0 per spec
 
     //Return 1 + the larger of the 2 subtrees!
-    return 1u + std::max(heightHelper(n->left), heightHelper(n->right));
+    return 1u + std::max(heightHelper(nodes_[n].left), heightHelper(nodes_[n].right));
 }
 
 
-void HuffmanTree::destroy(TreeNode* n) noexcept {
-    if (!n) return;
-    destroy(n->left);
-    destroy(n->right);
-    delete n;
-}
+HuffmanTree HuffmanTree::buildFromCounts(const std::vector<std::pair<std::string, std::size_t>>& counts,
+                                         BuildMethod method, unsigned maxCodeLength) {
+    HuffmanTree tree;
 
-HuffmanTree HuffmanTree::buildFromCounts(const std::vector<std::pair<std::string, std::size_t>>& counts) {
     // Edge case: no tokens -> empty tree
     if (counts.empty()) {
-        return HuffmanTree(nullptr);
+        return tree;
     }
 
-    // 1) Create one LEAF per (word,count). We allocate with `new` here and
-    //    let HuffmanTree's destructor own+delete the whole final tree.
+    // 1) Create one LEAF per (word,count). A full tree over V leaves has 2V-1 nodes;
+    //    reserving that up front means nodes_ never reallocates, so the TreeNode*
+    //    handles the PriorityQueue works with stay valid for the whole build.
+    //    'counts' is lex by word (from the counter), so leaf i gets tie-break key i.
+    const std::size_t leafCount = counts.size();
+    tree.nodes_.reserve(2 * leafCount - 1);
+    std::size_t wordBytes = 0;
+    for (const auto& wc : counts) wordBytes += wc.first.size();
+    tree.words_.reserve(wordBytes);
+
     std::vector<TreeNode*> leaves;
-    leaves.reserve(counts.size());
+    leaves.reserve(leafCount);
     for (const auto& [w, c] : counts) {
-        // Note: 'counts' is lex by word from your BST; PQ will re-order by (freq desc, key_word asc)
-        auto* leaf = new TreeNode(w, c);   // leaf: key_word = word
-        leaves.push_back(leaf);
+        const auto rank = static_cast<std::uint32_t>(tree.nodes_.size());
+        leaves.push_back(&tree.nodes_.emplace_back(tree.words_.add(w), c, rank));
     }
 
     // If there is only one distinct word, that single leaf IS the root.
-    if (leaves.size() == 1) {
-        return HuffmanTree(leaves[0]);
+    if (leafCount == 1) {
+        tree.root_ = 0;
+        return tree;
     }
 
-    // 2) Seed our non-owning PriorityQueue; MIN item sits at the BACK.
+    // 2) Merge the leaves into a tree.
+    tree.root_ = method == BuildMethod::TwoQueue ? tree.mergeTwoQueues()
+                                                 : tree.mergeWithHeap(std::move(leaves));
+
+    // 3) Length limit: the caller's, and never more than Codebook::kMaxCodeBits so
+    //    every code fits the flat codebook (a deeper plain tree needs Fibonacci-like
+    //    counts summing to well over 10^13, so in practice only an explicit limit
+    //    binds). Only applied when the plain Huffman tree is too deep, so a limit
+    //    that is not binding leaves the codes exactly as they were.
+    //    (height() counts nodes, so the longest code is height() - 1 bits.)
+    const unsigned limit = maxCodeLength == 0 ? Codebook::kMaxCodeBits
+                                              : std::min(maxCodeLength, Codebook::kMaxCodeBits);
+    if (tree.height() > limit + 1) tree.limitCodeLengths(limit);
+    return tree;
+}
+
+
+std::uint32_t HuffmanTree::mergeWithHeap(std::vector<TreeNode*> leaves) {
+    // 1) Seed our non-owning PriorityQueue (4-ary min-heap; MIN at the root).
+    //    PQ will re-order by (freq desc, key asc).
     PriorityQueue pq(std::move(leaves));
 
-    // 3) Merge two minima until one node remains.
+    // 2) Merge two minima until one node remains.
     //    The first extracted min becomes LEFT (code '0'),
     //    the second extracted min becomes RIGHT (code '1').
+    const TreeNode* base = nodes_.data();
+    auto indexOf = [base](const TreeNode* n) { return static_cast<std::uint32_t>(n - base); };
     while (pq.size() >= 2) {
         TreeNode* a = pq.extractMin();     // smallest
         TreeNode* b = pq.extractMin();     // next smallest
-        TreeNode* parent = new TreeNode(a, b); // sets count=sum, key_word=min
-        pq.insert(parent);                 // re-insert; PQ restores ordering
+        // sets count=sum, key=min
+        TreeNode& parent = nodes_.emplace_back(indexOf(a), *a, indexOf(b), *b);
+        pq.insert(&parent);                // re-insert; PQ restores ordering
     }
 
-    // 4) The final remaining node is the root.
-    TreeNode* root = pq.extractMin();      // PQ now empty
-    return HuffmanTree(root);
+    // 3) The final remaining node is the root.
+    return indexOf(pq.extractMin());       // PQ now empty
 }
 
 
-void HuffmanTree::buildCodebook(std::unordered_map<std::string,std::string>& out) const {
-    out.clear();
-    if (!root_) return;
-    std::vector<std::pair<std::string,std::string>> pairs; // (word,code)
-    std::string prefix;
-    assignCodesDFS(root_, prefix, pairs);
-    for (auto& [w,c] : pairs) out.emplace(w, c);
+std::uint32_t HuffmanTree::mergeTwoQueues() {
+    // Linear-time Huffman merge over the leaves already in nodes_.
+    //
+    // "a comes out before b" is exactly PriorityQueue's order: smaller count first,
+    // tie -> larger key first (the PQ keeps (count desc, key asc) with the MIN last).
+    auto extractsBefore = [this](std::uint32_t a, std::uint32_t b) {
+        const TreeNode& x = nodes_[a];
+        const TreeNode& y = nodes_[b];
+        if (x.count != y.count) return x.count < y.count;
+        return x.key > y.key;
+    };
+
+    // Queue 1: every leaf, sorted once into extraction order. Leaves are already in
+    // key order, so a stable counting sort by count gives (count desc, key asc);
+    // reversed, that is extraction order.
+    const auto leafCount = static_cast<std::uint32_t>(nodes_.size());
+    std::vector<std::uint32_t> leaves(leafCount);
+    for (std::uint32_t i = 0; i < leafCount; ++i) leaves[i] = i;
+    counting_sort::sortByCountDesc(leaves, [this](std::uint32_t i) { return nodes_[i].count; });
+    std::reverse(leaves.begin(), leaves.end());
+
+    // Queue 2: internal nodes. Each new parent's count is >= every parent made before
+    // it, so appending keeps this queue sorted by count. Only the key tie-break can
+    // need a fix-up: a new parent steps back over the tail run of equal-count parents
+    // with smaller keys, so equal counts still come out largest key first.
+    std::vector<std::uint32_t> internal;
+    internal.reserve(leafCount - 1);
+    std::size_t leafHead = 0, internalHead = 0;
+
+    // The overall minimum is the smaller of the two queue heads.
+    auto extractMin = [&]() {
+        if (internalHead == internal.size() ||
+            (leafHead < leaves.size() && extractsBefore(leaves[leafHead], internal[internalHead]))) {
+            return leaves[leafHead++];
+        }
+        return internal[internalHead++];
+    };
+
+    // Same merge as the PQ path: first min -> LEFT ('0'), second -> RIGHT ('1').
+    for (std::uint32_t merges = 1; merges < leafCount; ++merges) {
+        const std::uint32_t a = extractMin();
+        const std::uint32_t b = extractMin();
+        const auto parent = static_cast<std::uint32_t>(nodes_.size());
+        nodes_.emplace_back(a, nodes_[a], b, nodes_[b]); // sets count=sum, key=min
+
+        std::size_t pos = internal.size();
+        while (pos > internalHead && extractsBefore(parent, internal[pos - 1])) --pos;
+        internal.insert(internal.begin() + static_cast<std::ptrdiff_t>(pos), parent);
+    }
+
+    // The final remaining node is the root.
+    return extractMin();
 }
 
-void HuffmanTree::assignCodesDFS(const TreeNode* n, std::string& prefix,
-                                 std::vector<std::pair<std::string,std::string>>& out) {
-    if (!n)
-        return;
 
-    if (!n->left && !n->right) {
-        out.emplace_back(n->word, prefix.empty() ? "0" : prefix);
-        return;
+Codebook HuffmanTree::buildCodebook() const {
+    // One iterative walk gives every leaf its (bits, length); the words are then added
+    // in leaf order, so codebook ID i is leaf i (the word of lexicographic rank i).
+    Codebook book;
+    if (root_ == TreeNode::kNoNode) return book;
+
+    const std::size_t leafCount = (nodes_.size() + 1) / 2;
+    std::vector<Codebook::Code> codeOfLeaf(leafCount);
+    if (nodes_[root_].isLeaf()) {
+        codeOfLeaf[root_] = Codebook::Code{0, 1}; // a lone leaf still gets one bit: "0"
+    } else {
+        struct Pending { std::uint32_t node; std::uint64_t bits; unsigned len; };
+        std::vector<Pending> stack{{root_, 0, 0}};
+        while (!stack.empty()) {
+            const Pending p = stack.back();
+            stack.pop_back();
+            const TreeNode& n = nodes_[p.node];
+            if (n.isLeaf()) {
+                codeOfLeaf[p.node] = Codebook::Code{p.bits, static_cast<std::uint8_t>(p.len)};
+                continue;
+            }
+            // left = 0, right = 1 (depth <= kMaxCodeBits, see buildFromCounts)
+            stack.push_back({n.left,  p.bits << 1,       p.len + 1});
+            stack.push_back({n.right, (p.bits << 1) | 1, p.len + 1});
+        }
+    }
+
+    for (std::size_t i = 0; i < leafCount; ++i) {
+        book.add(words_.view(nodes_[i].word), codeOfLeaf[i].bits, codeOfLeaf[i].len);
+    }
+    return book;
+}
+
+std::shared_ptr<const Codebook> HuffmanTree::codebook() const {
+    if (!cache_) return std::make_shared<const Codebook>(); // moved-from tree
+    std::call_once(cache_->once, [this] { cache_->book = std::make_shared<const Codebook>(buildCodebook()); });
+    return cache_->book;
+}
+
+void HuffmanTree::canonicalize() {
+    canonical_ = true;
+    cache_ = std::make_unique<CodebookCache>(); // codes change: forget the old table
+    // 0 or 1 leaf: nothing to reassign (a lone leaf keeps code "0").
+    if (root_ == TreeNode::kNoNode || nodes_[root_].isLeaf()) return;
+
+    rebuildCanonical(leafDepths()); // lengths come from a real tree, so this cannot fail
+}
+
+std::vector<std::uint32_t> HuffmanTree::leafDepths() const {
+    // Depth of every leaf (= its code length). Leaves are nodes_[0..V-1].
+    const std::size_t leafCount = (nodes_.size() + 1) / 2;
+    std::vector<std::uint32_t> depth(leafCount, 0);
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> stack{{root_, 0}};
+    while (!stack.empty()) {
+        const auto [i, d] = stack.back();
+        stack.pop_back();
+        const TreeNode& n = nodes_[i];
+        if (n.isLeaf()) {
+            depth[i] = d;
+            continue;
+        }
+        stack.emplace_back(n.left, d + 1);
+        stack.emplace_back(n.right, d + 1);
+    }
+    return depth;
+}
+
+void HuffmanTree::limitCodeLengths(unsigned maxCodeLength) {
+    // Package-merge (Larmore & Hirschberg): optimal code lengths subject to
+    // length <= L. Called with at least 2 leaves.
+    //
+    // With the n leaf weights sorted ascending:
+    //   list(L)   = the leaves
+    //   list(l)   = merge(leaves, packages of consecutive pairs of list(l+1)), l = L-1..1
+    // Select the first 2n-2 items of list(1); a leaf's code length is the number of
+    // selected items it ends up inside. Expanding the selection level by level only
+    // needs to know how many packages a prefix holds: its leaves are always the
+    // smallest ones, because leaves enter every list in sorted order.
+    const std::size_t n = (nodes_.size() + 1) / 2;
+
+    // L must allow n distinct codes: 2^L >= n.
+    unsigned limit = maxCodeLength;
+    while (limit < 64 && (std::uint64_t{1} << limit) < n) ++limit;
+
+    // Leaves in ascending weight; ties in PriorityQueue extraction order (larger key
+    // first), so equal counts get deeper codes in the same order the plain build gives.
+    std::vector<std::uint32_t> order(n);
+    for (std::uint32_t i = 0; i < n; ++i) order[i] = i;
+    counting_sort::sortByCountDesc(order, [this](std::uint32_t i) { return nodes_[i].count; });
+    std::reverse(order.begin(), order.end());
+
+    // isPackage[l][j]: item j of list(l) is a package (levels 1..L-1; list(L) is all leaves).
+    std::vector<std::vector<bool>> isPackage(limit);
+    std::vector<std::uint64_t> prev(n), cur;
+    for (std::size_t j = 0; j < n; ++j) prev[j] = nodes_[order[j]].count;
+    for (unsigned l = limit - 1; l >= 1; --l) {
+        cur.clear();
+        auto& flags = isPackage[l];
+        flags.clear();
+        std::size_t leaf = 0, pkg = 0;
+        const std::size_t packages = prev.size() / 2;
+        while (leaf < n || pkg < packages) {
+            const bool takeLeaf =
+                pkg == packages ||
+                (leaf < n && nodes_[order[leaf]].count <= prev[2 * pkg] + prev[2 * pkg + 1]);
+            if (takeLeaf) {
+                cur.push_back(nodes_[order[leaf++]].count);
+                flags.push_back(false);
+            } else {
+                cur.push_back(prev[2 * pkg] + prev[2 * pkg + 1]);
+                ++pkg;
+                flags.push_back(true);
+            }
+        }
+        prev.swap(cur);
     }
-    prefix.push_back('0');
-    assignCodesDFS(n->left,  prefix, out);
-    prefix.pop_back();
 
+    // Expand the selection from list(1) down to list(L).
+    std::vector<std::uint32_t> depth(n, 0);
+    std::size_t take = 2 * n - 2;
+    for (unsigned l = 1; l < limit; ++l) {
+        std::size_t packages = 0;
+        for (std::size_t j = 0; j < take; ++j) packages += isPackage[l][j];
+        for (std::size_t j = 0; j < take - packages; ++j) ++depth[order[j]];
+        take = 2 * packages;
+    }
+    for (std::size_t j = 0; j < take; ++j) ++depth[order[j]];
 
-    prefix.push_back('1');
-    assignCodesDFS(n->right, prefix, out);
-    prefix.pop_back();
+    rebuildCanonical(depth); // package-merge lengths always form a complete code
+}
+
+bool HuffmanTree::rebuildCanonical(const std::vector<std::uint32_t>& depthOfLeaf) {
+    // Build the canonical tree bottom-up, one level at a time. On every level the
+    // canonical codes put leaves first (smallest codes, in word order) and the
+    // internal nodes after them, so:
+    //   level(d) = [leaves of length d, by word] + [parents of consecutive pairs of level(d+1)]
+    // Leaves are nodes_[0..V-1] in word order, so grouping them by depth with a stable
+    // counting sort already gives (length, word) order. O(V).
+    const auto leafCount = static_cast<std::uint32_t>(depthOfLeaf.size());
+    std::uint32_t maxDepth = 0;
+    for (const std::uint32_t d : depthOfLeaf) maxDepth = std::max(maxDepth, d);
+
+    std::vector<std::uint32_t> start(maxDepth + 2, 0);
+    for (const std::uint32_t d : depthOfLeaf) ++start[d + 1];
+    for (std::uint32_t d = 1; d < start.size(); ++d) start[d] += start[d - 1];
+    std::vector<std::uint32_t> byDepth(leafCount);
+    {
+        std::vector<std::uint32_t> next(start.begin(), start.end() - 1);
+        for (std::uint32_t i = 0; i < leafCount; ++i) byDepth[next[depthOfLeaf[i]]++] = i;
+    }
+
+    // Drop the old internal nodes; room for V-1 new ones keeps references stable.
+    nodes_.erase(nodes_.begin() + leafCount, nodes_.end());
+    nodes_.reserve(2 * static_cast<std::size_t>(leafCount) - 1);
+
+    std::vector<std::uint32_t> level, next;
+    for (std::uint32_t d = maxDepth; d >= 1; --d) {
+        next.assign(byDepth.begin() + start[d], byDepth.begin() + start[d + 1]);
+        if (level.size() % 2 != 0) return false;
+        for (std::size_t i = 0; i < level.size(); i += 2) {
+            const std::uint32_t l = level[i], r = level[i + 1];
+            next.push_back(static_cast<std::uint32_t>(nodes_.size()));
+            nodes_.emplace_back(l, nodes_[l], r, nodes_[r]);
+        }
+        level.swap(next);
+    }
+    // Depth 0 is the root: exactly two depth-1 nodes must remain (no leaf at depth 0).
+    if (level.size() != 2 || start[1] != 0) return false;
+    root_ = static_cast<std::uint32_t>(nodes_.size());
+    nodes_.emplace_back(level[0], nodes_[level[0]], level[1], nodes_[level[1]]);
+    return true;
 }
 
 error_type HuffmanTree::writeHeader(std::ostream& os) const {
-    if (!root_) return NO_ERROR; // empty header ok
+    if (canonical_) os << "#canonical\n";
+    if (root_ == TreeNode::kNoNode) return NO_ERROR; // empty header ok
     std::string prefix;
     writeHeaderPreorder(root_, prefix, os);
     if (os.fail()) return FAILED_TO_WRITE_FILE;
     return NO_ERROR;
 }
 
-void HuffmanTree::writeHeaderPreorder(const TreeNode* n, std::string& prefix, std::ostream& os) {
+void HuffmanTree::writeHeaderPreorder(std::uint32_t i, std::string& prefix, std::ostream& os) const {
     //Empty tree -> just return
-    if (!n) return;
+    if (i == TreeNode::kNoNode) return;
 
     //Check if this is a leaf node
-    if (!n->left && !n->right) {
-        os << n->word << ' ' << (prefix.empty() ? "0" : prefix) << '\n';
+    const TreeNode& n = nodes_[i];
+    if (n.isLeaf()) {
+        if (canonical_) {
+            // Pre-order visits a canonical tree in (length, word) order already.
+            os << words_.view(n.word) << ' ' << (prefix.empty() ? 1 : prefix.size()) << '\n';
+        } else {
+            os << words_.view(n.word) << ' ' << (prefix.empty() ? "0" : prefix) << '\n';
+        }
         return;
     }
 
     //Traverse left subtree
-    if (n->left != nullptr) {
+    if (n.left != TreeNode::kNoNode) {
         prefix.push_back('0');
-        writeHeaderPreorder(n->left,  prefix, os);
+        writeHeaderPreorder(n.left,  prefix, os);
         prefix.pop_back();
     }
 
     //traverse right subtree
-    if (n->right != nullptr) {
+    if (n.right != TreeNode::kNoNode) {
         prefix.push_back('1');
-        writeHeaderPreorder(n->right, prefix, os);
+        writeHeaderPreorder(n.right, prefix, os);
         prefix.pop_back();
     }
 }
 
 error_type HuffmanTree::encode(const std::vector<std::string>& tokens,
-                               std::ostream& os_bits, int wrap_cols) const {
-    std::unordered_map<std::string,std::string> code;
-    buildCodebook(code);
-    std::size_t col = 0;
-
+                               std::ostream& os_bits, int wrap_cols, CodeFormat format) const {
+    Encoder enc(*this, os_bits, wrap_cols, format);
     for (const auto& t : tokens) {
-        auto it = code.find(t);
-        if (it == code.end()) return FAILED_TO_WRITE_FILE; // or a custom mismatch error
-        const std::string& bits = it->second;
-        for (char b : bits) {
-            os_bits.put(b);
-            if (++col == static_cast<std::size_t>(wrap_cols)) {
-                os_bits.put('\n');
-                col = 0;
+        if (error_type err = enc.put(t); err != NO_ERROR) return err;
+    }
+    return enc.finish();
+}
+
+error_type HuffmanTree::encode(const std::vector<std::string_view>& tokens,
+                               std::ostream& os_bits, int wrap_cols, CodeFormat format) const {
+    Encoder enc(*this, os_bits, wrap_cols, format);
+    for (const auto t : tokens) {
+        if (error_type err = enc.put(t); err != NO_ERROR) return err;
+    }
+    return enc.finish();
+}
+
+error_type HuffmanTree::encode(const std::vector<std::uint32_t>& ids, const SymbolTable& symbols,
+                               std::ostream& os_bits, int wrap_cols, CodeFormat format) const {
+    Encoder enc(*this, os_bits, wrap_cols, format);
+
+    // One hash lookup per distinct symbol instead of one per token; after that each
+    // token is an index into a flat array of codes (len 0 = word not in the tree).
+    std::vector<Codebook::Code> codeOf(symbols.size());
+    for (std::uint32_t id = 0; id < codeOf.size(); ++id) {
+        const std::uint32_t sym = enc.book_->find(symbols.word(id));
+        if (sym != Codebook::kNoSymbol) codeOf[id] = enc.book_->code(sym);
+    }
+
+    for (const std::uint32_t id : ids) {
+        if (id >= codeOf.size() || codeOf[id].len == 0) return FAILED_TO_WRITE_FILE; // or a custom mismatch error
+        enc.emit(codeOf[id]);
+    }
+    return enc.finish();
+}
+
+error_type HuffmanTree::encodeBatch(const std::vector<std::vector<std::string_view>>& docs,
+                                    const std::vector<std::ostream*>& outs,
+                                    int wrap_cols, CodeFormat format, unsigned threads) const {
+    if (docs.size() != outs.size()) return FAILED_TO_WRITE_FILE;
+
+    // Workers take the next unclaimed document until none are left; every document
+    // has its own stream, so nothing else is shared.
+    std::vector<error_type> results(docs.size(), NO_ERROR);
+    std::atomic<std::size_t> next{0};
+    auto work = [&]() {
+        for (std::size_t i = next++; i < docs.size(); i = next++) {
+            results[i] = outs[i] ? encode(docs[i], *outs[i], wrap_cols, format) : FAILED_TO_WRITE_FILE;
+        }
+    };
+
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t workers = std::clamp<std::size_t>(docs.size(), 1, threads);
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (std::size_t w = 1; w < workers; ++w) pool.emplace_back(work);
+    work(); // the calling thread takes a share too
+    for (auto& t : pool) t.join();
+
+    for (const error_type err : results) {
+        if (err != NO_ERROR) return err;
+    }
+    return NO_ERROR;
+}
+
+error_type HuffmanTree::encodeParallel(const std::vector<std::string_view>& tokens,
+                                       std::ostream& os_bits, int wrap_cols, CodeFormat format,
+                                       unsigned threads) const {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t workers =
+        std::clamp<std::size_t>(tokens.size() / kMinTokensPerEncodeThread, 1, threads);
+    if (workers == 1) return encode(tokens, os_bits, wrap_cols, format);
+
+    const std::shared_ptr<const Codebook> book = codebook();
+    auto runAll = [workers](auto&& fn) {
+        std::vector<std::thread> pool;
+        pool.reserve(workers - 1);
+        for (std::size_t w = 1; w < workers; ++w) pool.emplace_back(fn, w);
+        fn(0); // the calling thread takes a share too
+        for (auto& t : pool) t.join();
+    };
+    auto sliceBegin = [&](std::size_t w) { return tokens.size() * w / workers; };
+
+    // 1) Look every token up once and total its slice's code bits.
+    std::vector<std::uint32_t> sym(tokens.size());
+    std::vector<std::uint64_t> offset(workers + 1, 0); // offset[w + 1] = bits of slice w, for now
+    std::vector<char> missing(workers, 0);
+    runAll([&](std::size_t w) {
+        std::uint64_t bits = 0;
+        for (std::size_t i = sliceBegin(w), end = sliceBegin(w + 1); i < end; ++i) {
+            sym[i] = book->find(tokens[i]);
+            if (sym[i] == Codebook::kNoSymbol) {
+                missing[w] = 1;
+                return;
             }
+            bits += book->code(sym[i]).len;
         }
+        offset[w + 1] = bits;
+    });
+    for (const char m : missing) {
+        if (m) return FAILED_TO_WRITE_FILE; // or a custom mismatch error
     }
-    if (col != 0) os_bits.put('\n'); // final newline
+
+    // 2) Exclusive prefix sum: slice w starts at output bit offset[w].
+    for (std::size_t w = 0; w < workers; ++w) offset[w + 1] += offset[w];
+    const std::uint64_t totalBits = offset[workers];
+
+    // 3) Every slice writes straight into its part of one output buffer.
+    std::vector<char> out;
+    if (format == CodeFormat::Binary) {
+        // Same bytes BitWriter produces, but the bit count is known up front.
+        out.assign(BitWriter::kHeaderBytes + (totalBits + 7) / 8, 0);
+        std::memcpy(out.data(), BitWriter::kMagic.data(), BitWriter::kMagic.size());
+        for (int i = 0; i < 8; ++i) out[BitWriter::kMagic.size() + i] = static_cast<char>(totalBits >> (8 * i));
+        auto* bytes = reinterpret_cast<unsigned char*>(out.data() + BitWriter::kHeaderBytes);
+
+        std::vector<std::optional<SliceBitWriter>> slices(workers);
+        runAll([&](std::size_t w) {
+            if (offset[w] == offset[w + 1]) return;
+            SliceBitWriter& bw = slices[w].emplace(bytes, offset[w], offset[w + 1]);
+            for (std::size_t i = sliceBegin(w), end = sliceBegin(w + 1); i < end; ++i) {
+                const Codebook::Code& c = book->code(sym[i]);
+                bw.put(c.bits, c.len);
+            }
+            bw.finish();
+        });
+        for (const auto& bw : slices) {
+            if (bw) bw->mergeEdges();
+        }
+    } else {
+        // Bit b lands at column b % wrap of line b / wrap, i.e. at b + b / wrap; the bit
+        // that fills a line also writes its newline. A partial last line gets one too.
+        // wrap_cols <= 0 (no line breaks, as in encode()) is one line that never fills.
+        const std::uint64_t wrap = wrap_cols > 0 ? static_cast<std::uint64_t>(wrap_cols) : totalBits + 1;
+        out.resize(totalBits + (totalBits + wrap - 1) / wrap);
+        if (totalBits % wrap != 0) out.back() = '\n';
+        runAll([&](std::size_t w) {
+            char* pos = out.data() + offset[w] + offset[w] / wrap;
+            std::uint64_t col = offset[w] % wrap;
+            char text[Codebook::kMaxCodeBits];
+            for (std::size_t i = sliceBegin(w), end = sliceBegin(w + 1); i < end; ++i) {
+                const std::size_t len = Codebook::spell(book->code(sym[i]), text);
+                for (std::size_t done = 0; done < len;) {
+                    const std::size_t n = std::min<std::uint64_t>(len - done, wrap - col);
+                    std::memcpy(pos, text + done, n);
+                    pos += n;
+                    done += n;
+                    col += n;
+                    if (col == wrap) {
+                        *pos++ = '\n';
+                        col = 0;
+                    }
+                }
+            }
+        });
+    }
+
+    os_bits.write(out.data(), static_cast<std::streamsize>(out.size()));
     if (os_bits.fail()) return FAILED_TO_WRITE_FILE;
     return NO_ERROR;
 }
+
+std::vector<std::uint32_t> HuffmanTree::headerOrder() const {
+    // Same pre-order walk as writeHeaderPreorder, numbering the leaves as it meets them.
+    std::vector<std::uint32_t> line((nodes_.size() + 1) / 2, 0);
+    if (root_ == TreeNode::kNoNode) return line;
+    std::uint32_t next = 0;
+    std::vector<std::uint32_t> stack{root_};
+    while (!stack.empty()) {
+        const TreeNode& n = nodes_[stack.back()];
+        const std::uint32_t i = stack.back();
+        stack.pop_back();
+        if (n.isLeaf()) {
+            line[i] = next++;
+            continue;
+        }
+        stack.push_back(n.right); // popped after the whole left subtree
+        stack.push_back(n.left);
+    }
+    return line;
+}
+
+error_type HuffmanTree::encodeBlocks(const std::vector<std::string_view>& tokens, std::ostream& os,
+                                     std::uint64_t tokensPerBlock, unsigned threads,
+                                     bool adaptive) const {
+    if (tokensPerBlock == 0) tokensPerBlock = BlockIndex::kDefaultTokensPerBlock;
+    // A block never needs to be larger than the whole input (this also keeps the
+    // block count below from overflowing for huge N).
+    tokensPerBlock = std::min<std::uint64_t>(tokensPerBlock, std::max<std::size_t>(1, tokens.size()));
+    const std::shared_ptr<const Codebook> book = codebook();
+    const std::size_t blocks = tokens.empty() ? 0 : (tokens.size() - 1) / tokensPerBlock + 1;
+    const std::vector<std::uint32_t> line = adaptive ? headerOrder() : std::vector<std::uint32_t>{};
+
+    // Blocks are independent: workers claim the next one, look its tokens up, total
+    // their bits, then pack them into the block's own byte buffer.
+    std::vector<std::vector<unsigned char>> data(blocks);
+    std::vector<std::uint64_t> bits(blocks, 0);
+    std::atomic<bool> missing{false};
+    std::atomic<std::size_t> next{0};
+    auto work = [&]() {
+        std::vector<std::uint32_t> sym;
+        std::vector<Codebook::Code> local;                 // adaptive: global ID -> block code
+        std::vector<std::size_t> seen(adaptive ? book->size() : 0, 0); // adaptive: per-ID count
+        for (std::size_t b = next++; b < blocks && !missing; b = next++) {
+            const std::size_t begin = b * tokensPerBlock;
+            const std::size_t end = std::min<std::size_t>(tokens.size(), begin + tokensPerBlock);
+            sym.clear();
+            std::uint64_t codeBits = 0;
+            for (std::size_t i = begin; i < end; ++i) {
+                sym.push_back(book->find(tokens[i]));
+                if (sym.back() == Codebook::kNoSymbol) {
+                    missing = true;
+                    return;
+                }
+                codeBits += book->code(sym.back()).len;
+            }
+
+            std::vector<unsigned char> table; // adaptive: the block's code table
+            const Codebook* use = book.get();
+            if (adaptive) {
+                table = blockCodeTable(*book, line, sym, seen, local, codeBits);
+                if (table[0] == 1) use = nullptr; // the block's own code, in 'local'
+            }
+
+            bits[b] = 8 * table.size() + codeBits;
+            data[b].assign(table.size() + (codeBits + 7) / 8, 0);
+            std::copy(table.begin(), table.end(), data[b].begin());
+            SliceBitWriter bw(data[b].data() + table.size(), 0, codeBits);
+            for (const std::uint32_t s : sym) {
+                const Codebook::Code& c = use ? use->code(s) : local[s];
+                bw.put(c.bits, c.len);
+            }
+            bw.finish();
+            bw.mergeEdges();
+        }
+    };
+
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t workers = std::clamp<std::size_t>(blocks, 1, threads);
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (std::size_t w = 1; w < workers; ++w) pool.emplace_back(work);
+    work(); // the calling thread takes a share too
+    for (auto& t : pool) t.join();
+    if (missing) return FAILED_TO_WRITE_FILE; // or a custom mismatch error
+
+    // Header, blocks in order, then the index of where they landed.
+    BlockIndex index(tokensPerBlock, adaptive);
+    if (error_type err = index.writeHeader(os); err != NO_ERROR) return err;
+    std::uint64_t offset = BlockIndex::kHeaderBytes;
+    for (std::size_t b = 0; b < blocks; ++b) {
+        const std::uint64_t count = std::min<std::uint64_t>(tokensPerBlock, tokens.size() - b * tokensPerBlock);
+        index.add(offset, bits[b], count);
+        os.write(reinterpret_cast<const char*>(data[b].data()), static_cast<std::streamsize>(data[b].size()));
+        offset += data[b].size();
+    }
+    return index.writeIndex(os, offset);
+}
+
+std::vector<unsigned char> HuffmanTree::blockCodeTable(const Codebook& book,
+                                                       const std::vector<std::uint32_t>& line,
+                                                       const std::vector<std::uint32_t>& sym,
+                                                       std::vector<std::size_t>& seen,
+                                                       std::vector<Codebook::Code>& local,
+                                                       std::uint64_t& codeBits) {
+    // The block's own counts, in global ID order (= word order).
+    std::vector<std::uint32_t> ids;
+    for (const std::uint32_t s : sym) {
+        if (seen[s]++ == 0) ids.push_back(s);
+    }
+    std::sort(ids.begin(), ids.end());
+    std::vector<std::pair<std::string, std::size_t>> counts;
+    counts.reserve(ids.size());
+    for (const std::uint32_t s : ids) {
+        counts.emplace_back(std::string(book.word(s)), std::exchange(seen[s], 0));
+    }
+
+    // A canonical tree over just these words; its ID j is ids[j] (both in word order).
+    HuffmanTree tree = buildFromCounts(counts);
+    tree.canonicalize();
+    const std::shared_ptr<const Codebook> own = tree.codebook();
+
+    std::uint64_t ownBits = 0;
+    for (std::size_t j = 0; j < ids.size(); ++j) ownBits += counts[j].second * own->code(j).len;
+    const std::size_t tableBytes = 5 + 5 * ids.size();
+
+    // Keep the global code unless the block's own code pays for its table.
+    if (8 * tableBytes + ownBits >= 8 + codeBits) return {0};
+
+    // (length, word) order is the order canonicalize() handed the codes out in.
+    std::vector<std::uint32_t> order(ids.size());
+    for (std::uint32_t j = 0; j < order.size(); ++j) order[j] = j;
+    std::sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) {
+        return std::pair(own->code(a).len, a) < std::pair(own->code(b).len, b);
+    });
+
+    std::vector<unsigned char> table(tableBytes);
+    table[0] = 1;
+    auto put32 = [&](std::size_t at, std::uint32_t v) {
+        for (int i = 0; i < 4; ++i) table[at + i] = static_cast<unsigned char>(v >> (8 * i));
+    };
+    put32(1, static_cast<std::uint32_t>(ids.size()));
+    for (std::size_t k = 0; k < order.size(); ++k) {
+        put32(5 + 5 * k, line[ids[order[k]]]);
+        table[5 + 5 * k + 4] = own->code(order[k]).len;
+    }
+
+    if (local.size() < book.size()) local.resize(book.size());
+    for (std::size_t j = 0; j < ids.size(); ++j) local[ids[j]] = own->code(j);
+    codeBits = ownBits;
+    return table;
+}
+
+HuffmanTree::Encoder::Encoder(const HuffmanTree& tree, std::ostream& os_bits, int wrap_cols,
+                              CodeFormat format)
+    : Encoder(tree.codebook(), os_bits, wrap_cols, format) {}
+
+HuffmanTree::Encoder::Encoder(std::shared_ptr<const Codebook> book, std::ostream& os_bits,
+                              int wrap_cols, CodeFormat format)
+    : book_(std::move(book)), os_(os_bits),
+      wrap_(wrap_cols > 0 ? static_cast<std::size_t>(wrap_cols) : SIZE_MAX) { // <= 0: never wrap
+    if (format == CodeFormat::Binary) packed_.emplace(os_bits);
+}
+
+error_type HuffmanTree::Encoder::put(std::string_view word) {
+    const std::uint32_t id = book_->find(word);
+    if (id == Codebook::kNoSymbol) return FAILED_TO_WRITE_FILE; // or a custom mismatch error
+    emit(book_->code(id));
+    return NO_ERROR;
+}
+
+void HuffmanTree::Encoder::emit(const Codebook::Code& code) {
+    if (packed_) {
+        packed_->put(code.bits, code.len);
+        return;
+    }
+    // ASCII: spell the code, then write it in pieces that end at the wrap column.
+    char text[Codebook::kMaxCodeBits];
+    const std::size_t len = Codebook::spell(code, text);
+    for (std::size_t done = 0; done < len;) {
+        const std::size_t n = std::min(len - done, wrap_ - col_);
+        os_.write(text + done, static_cast<std::streamsize>(n));
+        done += n;
+        col_ += n;
+        if (col_ == wrap_) {
+            os_.put('\n');
+            col_ = 0;
+        }
+    }
+}
+
+error_type HuffmanTree::Encoder::finish() {
+    if (packed_) return packed_->finish();
+    if (col_ != 0) os_.put('\n'); // final newline
+    col_ = 0;
+    if (os_.fail()) return FAILED_TO_WRITE_FILE;
+    return NO_ERROR;
+}
@@ -3,46 +3,199 @@
 
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
 #include <ostream>
-#include <unordered_map>
 #include <algorithm>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <cstdint>
 #include "TreeNode.h"
+#include "StringPool.h"
+#include "BitWriter.h"
+#include "Codebook.h"
 #include "PriorityQueue.h"
+#include "SymbolTable.h"
 #include "utils.hpp" // for error_type if you have it
 
 class HuffmanTree {
 public:
-    static HuffmanTree buildFromCounts(const std::vector<std::pair<std::string, std::size_t>>& counts);
-    ~HuffmanTree();
+    // How buildFromCounts merges the leaves. Both give the same tree, bit for bit.
+    //  Heap     – PriorityQueue (4-ary heap), O(V log V).
+    //  TwoQueue – sort the leaves once, then merge from two FIFO queues (sorted leaves,
+    //             internal nodes in creation order); O(V) after the sort.
+    enum class BuildMethod { Heap, TwoQueue };
+
+    // .code output format.
+    //  Ascii  – one '0'/'1' character per bit, wrapped to wrap_cols, final newline
+    //           (the original, human-readable format).
+    //  Binary – bits packed 8 per byte behind a small header (see BitWriter.h);
+    //           wrap_cols is ignored. Needs a seekable stream opened in binary mode.
+    enum class CodeFormat { Ascii, Binary };
+
+    // Codes never exceed Codebook::kMaxCodeBits (64) bits; see Codebook.h.
+    // maxCodeLength > 0 bounds every code by that many bits (height() by one more), using
+    // package-merge for the optimal lengths under the limit; the limited tree is laid
+    // out canonically. It only kicks in when the plain tree is deeper than the limit.
+    // A limit below ceil(log2 V) cannot hold V codes and is raised to that minimum.
+    static HuffmanTree buildFromCounts(const std::vector<std::pair<std::string, std::size_t>>& counts,
+                                       BuildMethod method = BuildMethod::Heap,
+                                       unsigned maxCodeLength = 0);
+    ~HuffmanTree() = default; // nodes and words live in two flat buffers
     HuffmanTree() = default;
 
-    // Build a (word -> code) table (left=0, right=1; pre-order left before right).
-    void buildCodebook(std::unordered_map<std::string,std::string>& out) const;
+    // Owns its nodes: non-copyable, movable.
+    HuffmanTree(const HuffmanTree&) = delete;
+    HuffmanTree& operator=(const HuffmanTree&) = delete;
+    HuffmanTree(HuffmanTree&& other) noexcept;
+    HuffmanTree& operator=(HuffmanTree&& other) noexcept;
+
+    // Flat (word -> ID -> bits, length) table (left=0, right=1). ID i is leaf i, i.e.
+    // the word of lexicographic rank i. A lone leaf gets the 1-bit code "0".
+    [[nodiscard]] Codebook buildCodebook() const;
+
+    // The same table, built on first use and then kept: every encode(), encodeBatch()
+    // and Encoder shares it. Thread-safe (std::call_once), so concurrent encodes of
+    // one tree build it once. canonicalize() drops it; do not change the tree while
+    // encodes are running.
+    [[nodiscard]] std::shared_ptr<const Codebook> codebook() const;
 
     // Emit leaves in pre-order as "word<space>code\n" (deterministic). Final newline.
+    // After canonicalize(): "#canonical\n" then "word<space>length\n" per leaf in
+    // (length, word) order; the codes follow from that order (see canonicalize()).
     error_type writeHeader(std::ostream& os) const;
 
-    // Encode tokens using this codebook; wrap lines to wrap_cols (80 default), final newline.
+    // Canonical Huffman: keep every word's code length, but reassign the codes so
+    // that, taking words in (length, word) order, each code is the previous one plus
+    // one (shifted left when the length grows). The tree is rebuilt to match, so
+    // buildCodebook/encode/Encoder use the canonical codes; height is unchanged.
+    // Lengths alone then describe the code, which is all the header has to store.
+    void canonicalize();
+    [[nodiscard]] bool isCanonical() const noexcept { return canonical_; }
+
+    // Encode tokens using this codebook; wrap lines to wrap_cols (80 default; <= 0 = no
+    // line breaks), final newline.
     error_type encode(const std::vector<std::string>& tokens,
                       std::ostream& os_bits,
-                      int wrap_cols = 80) const;
+                      int wrap_cols = 80,
+                      CodeFormat format = CodeFormat::Ascii) const;
+    error_type encode(const std::vector<std::string_view>& tokens,
+                      std::ostream& os_bits,
+                      int wrap_cols = 80,
+                      CodeFormat format = CodeFormat::Ascii) const;
+
+    // Encode interned tokens (Scanner::tokenizeSymbols). Each distinct symbol's code is
+    // looked up once; after that every token is a plain array index. Same output as
+    // encode() over the corresponding words.
+    error_type encode(const std::vector<std::uint32_t>& ids,
+                      const SymbolTable& symbols,
+                      std::ostream& os_bits,
+                      int wrap_cols = 80,
+                      CodeFormat format = CodeFormat::Ascii) const;
+
+    // Multi-threaded encode() of one token list, byte-identical to it. Every code length
+    // is known from the codebook, so each worker totals its slice's bits, a prefix sum
+    // over the slices gives each one its output bit offset, and the workers then write
+    // their slices into one buffer at those offsets (ASCII line breaks follow from the
+    // offset too). Only the bytes where binary slices meet are merged after the join.
+    // The whole output is built in memory before it is written; the stream need not be
+    // seekable. Below ~64K tokens per worker it uses fewer threads (0 = all cores).
+    error_type encodeParallel(const std::vector<std::string_view>& tokens,
+                              std::ostream& os_bits,
+                              int wrap_cols = 80,
+                              CodeFormat format = CodeFormat::Ascii,
+                              unsigned threads = 0) const;
+
+    // Write the tokens as a block container (see BlockIndex.h): blocks of tokensPerBlock
+    // tokens (0 = BlockIndex::kDefaultTokensPerBlock), each byte-aligned, then an index.
+    // Blocks are encoded on up to 'threads' workers (0 = all cores); the file is the
+    // same for any thread count. The bits of each block are those encode() would give.
+    // adaptive: also build a canonical tree from each block's own counts and use it
+    // (table inline, see BlockIndex.h) when that is estimated to take fewer bits than
+    // the global code plus the table. The .hdr still serves every block.
+    error_type encodeBlocks(const std::vector<std::string_view>& tokens,
+                            std::ostream& os,
+                            std::uint64_t tokensPerBlock = 0,
+                            unsigned threads = 1,
+                            bool adaptive = false) const;
+
+    // Encode several token streams against this tree in one call: docs[i] -> outs[i],
+    // each exactly as encode(docs[i], *outs[i], ...) would. All of them share the cached
+    // codebook; up to 'threads' documents are encoded at once (1 = one after another,
+    // 0 = all cores). Returns the first error in document order.
+    error_type encodeBatch(const std::vector<std::vector<std::string_view>>& docs,
+                           const std::vector<std::ostream*>& outs,
+                           int wrap_cols = 80,
+                           CodeFormat format = CodeFormat::Ascii,
+                           unsigned threads = 1) const;
+
+    // Incremental form of encode() for callers that stream tokens instead of holding
+    // them in a vector. Output is identical to encode() over the same token sequence.
+    // The Encoder holds the tree's cached codebook (it stays valid even if the tree
+    // goes away); put() is one hash probe plus an array index.
+    class Encoder {
+    public:
+        explicit Encoder(const HuffmanTree& tree, std::ostream& os_bits, int wrap_cols = 80,
+                         CodeFormat format = CodeFormat::Ascii);
+        // Same, over a codebook that did not come from a tree (e.g. a Dictionary's).
+        explicit Encoder(std::shared_ptr<const Codebook> book, std::ostream& os_bits,
+                         int wrap_cols = 80, CodeFormat format = CodeFormat::Ascii);
+
+        error_type put(std::string_view word); // append the code for one token
+        void emit(const Codebook::Code& code); // append one code as is
+        error_type finish();                   // final newline (or bit flush) + stream check
+
+    private:
+        friend class HuffmanTree;
+
+        std::shared_ptr<const Codebook> book_; // the codes, flat
+        std::ostream& os_;
+        std::size_t wrap_;
+        std::size_t col_ = 0;
+        std::optional<BitWriter> packed_; // engaged in CodeFormat::Binary
+    };
 
     // Optional metric
     unsigned height() const noexcept;
 
 private:
-    explicit HuffmanTree(TreeNode* root) : root_(root) {}
-    TreeNode* root_ = nullptr;
-
-    static void destroy(TreeNode* n) noexcept;
-    static void assignCodesDFS(const TreeNode* n,
-                               std::string& prefix,
-                               std::vector<std::pair<std::string,std::string>>& out);
-    static void writeHeaderPreorder(const TreeNode* n,
-                               std::string& prefix,
-                               std::ostream& os);
-    static unsigned heightHelper(const TreeNode* n) noexcept;
+    // Leaves are nodes_[0..V-1] in lexicographic word order (so leaf i has key i);
+    // internal nodes follow. Children are indices into nodes_, words live in words_.
+    std::vector<TreeNode> nodes_;
+    StringPool words_;
+    std::uint32_t root_ = TreeNode::kNoNode;
+    bool canonical_ = false;
+
+    // Lazily built codebook. Behind a pointer so the tree stays movable (once_flag
+    // is not); a moved-from tree has none and reports an empty codebook.
+    struct CodebookCache {
+        std::once_flag once;
+        std::shared_ptr<const Codebook> book;
+    };
+    std::unique_ptr<CodebookCache> cache_ = std::make_unique<CodebookCache>();
+
+    std::uint32_t mergeWithHeap(std::vector<TreeNode*> leaves); // returns the root index
+    std::uint32_t mergeTwoQueues();                             // returns the root index
+    void limitCodeLengths(unsigned maxCodeLength);
+    [[nodiscard]] std::vector<std::uint32_t> leafDepths() const; // code length per leaf
+    [[nodiscard]] std::vector<std::uint32_t> headerOrder() const; // .hdr line per leaf
+
+    // encodeBlocks(adaptive): the block's table bytes ({0} = keep the global code).
+    // When the block gets its own code, local[id] is filled in for its words and
+    // codeBits becomes the block's size under that code. 'seen' is zeroed scratch.
+    static std::vector<unsigned char> blockCodeTable(const Codebook& book,
+                                                     const std::vector<std::uint32_t>& line,
+                                                     const std::vector<std::uint32_t>& sym,
+                                                     std::vector<std::size_t>& seen,
+                                                     std::vector<Codebook::Code>& local,
+                                                     std::uint64_t& codeBits);
+    bool rebuildCanonical(const std::vector<std::uint32_t>& depthOfLeaf); // false: not a full code
+
+    void writeHeaderPreorder(std::uint32_t n,
+                             std::string& prefix,
+                             std::ostream& os) const;
+    unsigned heightHelper(std::uint32_t n) const noexcept;
 };
 
 #endif //IMPLEMENTATION_HUFFMANTREE_H
\ No newline at end of file
@@ -0,0 +1,40 @@
+//
+// MappedFile.h
+//
+// Read-only memory mapping of an input file (POSIX mmap).
+// The Scanner's zero-copy mode hands out std::string_view tokens that point
+// straight into this mapping, so the MappedFile must outlive those views.
+//
+
+#ifndef IMPLEMENTATION_MAPPEDFILE_H
+#define IMPLEMENTATION_MAPPEDFILE_H
+
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include "utils.hpp"
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile(); // unmaps if open
+
+    // Owns the mapping: non-copyable, movable.
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // Map 'path' read-only. An empty file is a valid (empty) mapping.
+    error_type open(const std::filesystem::path& path);
+    void close() noexcept;
+
+    [[nodiscard]] const char* data() const noexcept { return data_; }
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+#endif //IMPLEMENTATION_MAPPEDFILE_H
@@ -0,0 +1,92 @@
+//
+// NodeArena.h
+//
+// Typed bump allocator for tree nodes.
+// Nodes are constructed back to back in large blocks, so building a tree does one
+// malloc per block instead of one per node, neighbouring nodes share cache lines,
+// and teardown is a linear sweep over the blocks instead of a recursive delete.
+// (For trivially destructible node types the sweep is skipped entirely and
+// release() just frees the blocks.)
+//
+// Nodes are never freed individually; everything goes away together in release()
+// or the destructor. Pointers stay valid until then, including across moves.
+//
+
+#ifndef IMPLEMENTATION_NODEARENA_H
+#define IMPLEMENTATION_NODEARENA_H
+
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template <typename T>
+class NodeArena {
+public:
+    NodeArena() = default;
+    ~NodeArena() { release(); }
+
+    // Owns the nodes: non-copyable, movable.
+    NodeArena(const NodeArena&) = delete;
+    NodeArena& operator=(const NodeArena&) = delete;
+    NodeArena(NodeArena&& other) noexcept
+        : blocks_(std::move(other.blocks_)), used_(std::exchange(other.used_, kBlockObjects)),
+          count_(std::exchange(other.count_, 0)) {}
+    NodeArena& operator=(NodeArena&& other) noexcept {
+        if (this != &other) {
+            release();
+            blocks_ = std::move(other.blocks_);
+            used_ = std::exchange(other.used_, kBlockObjects);
+            count_ = std::exchange(other.count_, 0);
+        }
+        return *this;
+    }
+
+    // Construct a T in the arena and return it.
+    template <typename... Args>
+    T* make(Args&&... args) {
+        if (used_ == kBlockObjects) {
+            blocks_.push_back(std::make_unique_for_overwrite<Storage[]>(kBlockObjects));
+            used_ = 0;
+        }
+        T* p = ::new (static_cast<void*>(blocks_.back()[used_].bytes)) T(std::forward<Args>(args)...);
+        ++used_;
+        ++count_;
+        return p;
+    }
+
+    // Destroy every node and free every block.
+    void release() noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (std::size_t b = 0; b < blocks_.size(); ++b) {
+                const std::size_t n = (b + 1 == blocks_.size()) ? used_ : kBlockObjects;
+                for (std::size_t i = 0; i < n; ++i) {
+                    std::launder(reinterpret_cast<T*>(blocks_[b][i].bytes))->~T();
+                }
+            }
+        }
+        blocks_.clear();
+        used_ = kBlockObjects;
+        count_ = 0;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return count_; } // live nodes
+
+private:
+    struct Storage {
+        alignas(T) std::byte bytes[sizeof(T)];
+    };
+
+    // ~64 KiB per block (at least 64 nodes for very large T).
+    static constexpr std::size_t kBlockObjects =
+        sizeof(T) * 64 > 64 * 1024 ? 64 : (64 * 1024) / sizeof(T);
+
+    std::vector<std::unique_ptr<Storage[]>> blocks_;
+    std::size_t used_ = kBlockObjects; // slots used in blocks_.back(); "full" when empty
+    std::size_t count_ = 0;
+};
+
+#endif //IMPLEMENTATION_NODEARENA_H
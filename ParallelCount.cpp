@@ -0,0 +1,137 @@
+//
+// ParallelCount.cpp
+//
+
+#include "ParallelCount.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include "WordHash.h"
+
+namespace {
+    // Below this many tokens per worker, countParallel() stops adding threads.
+    constexpr std::size_t kMinTokensPerThread = 64 * 1024;
+    constexpr std::size_t kInitialSlots = 256;
+
+    // Shard from the high hash bits; tables index slots with the low bits.
+    std::size_t shardOf(std::uint32_t h, std::size_t shards) noexcept {
+        return static_cast<std::size_t>((static_cast<std::uint64_t>(h) * shards) >> 32);
+    }
+
+    struct Entry {
+        std::string_view word;
+        std::uint64_t count = 0; // 0 = empty slot
+        std::uint64_t first = 0; // index of the word's first token
+        std::uint32_t hash = 0;
+    };
+
+    // Private per-worker table: linear probing, load <= 1/2, words stored as views.
+    class CountTable {
+    public:
+        CountTable() : slots_(kInitialSlots) {}
+
+        void add(std::string_view w, std::uint32_t h, std::uint64_t count, std::uint64_t first) {
+            std::size_t mask = slots_.size() - 1;
+            std::size_t i = h & mask;
+            for (;; i = (i + 1) & mask) {
+                Entry& e = slots_[i];
+                if (e.count == 0) break;
+                if (e.hash == h && e.word == w) {
+                    e.count += count;
+                    e.first = std::min(e.first, first);
+                    return;
+                }
+            }
+            if (2 * (size_ + 1) > slots_.size()) {
+                grow();
+                mask = slots_.size() - 1;
+                for (i = h & mask; slots_[i].count != 0; i = (i + 1) & mask) {}
+            }
+            slots_[i] = Entry{w, count, first, h};
+            ++size_;
+        }
+
+        // Live entries, in slot order.
+        template <typename Fn>
+        void forEach(Fn&& fn) const {
+            for (const Entry& e : slots_) {
+                if (e.count != 0) fn(e);
+            }
+        }
+
+        [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+    private:
+        std::vector<Entry> slots_; // power-of-two size
+        std::size_t size_ = 0;
+
+        void grow() {
+            std::vector<Entry> old(slots_.size() * 2);
+            old.swap(slots_);
+            const std::size_t mask = slots_.size() - 1;
+            for (const Entry& e : old) {
+                if (e.count == 0) continue;
+                std::size_t i = e.hash & mask;
+                while (slots_[i].count != 0) i = (i + 1) & mask;
+                slots_[i] = e;
+            }
+        }
+    };
+}
+
+std::vector<WordCount> countParallel(const std::vector<std::string_view>& tokens, unsigned threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t workers =
+        std::clamp<std::size_t>(tokens.size() / kMinTokensPerThread, 1, threads);
+
+    // tables[w][s] = worker w's counts for the words of shard s.
+    std::vector<std::vector<CountTable>> tables(workers, std::vector<CountTable>(workers));
+
+    // 1) Count: worker w takes the w-th contiguous slice of the tokens.
+    auto countSlice = [&](std::size_t w) {
+        const std::size_t begin = tokens.size() * w / workers;
+        const std::size_t end = tokens.size() * (w + 1) / workers;
+        auto& mine = tables[w];
+        for (std::size_t i = begin; i < end; ++i) {
+            const std::uint32_t h = wordHash(tokens[i]);
+            mine[shardOf(h, workers)].add(tokens[i], h, 1, i);
+        }
+    };
+
+    // 2) Reduce: worker s folds shard s of every other worker into tables[0][s],
+    //    then flattens it. Shards are disjoint, so nothing is shared between workers.
+    std::vector<std::vector<Entry>> shards(workers);
+    auto reduceShard = [&](std::size_t s) {
+        CountTable& into = tables[0][s];
+        for (std::size_t w = 1; w < workers; ++w) {
+            tables[w][s].forEach([&](const Entry& e) { into.add(e.word, e.hash, e.count, e.first); });
+            tables[w][s] = CountTable(); // free it early
+        }
+        shards[s].reserve(into.size());
+        into.forEach([&](const Entry& e) { shards[s].push_back(e); });
+    };
+
+    auto runAll = [workers](auto&& fn) {
+        std::vector<std::thread> pool;
+        pool.reserve(workers - 1);
+        for (std::size_t w = 1; w < workers; ++w) pool.emplace_back(fn, w);
+        fn(0); // the calling thread takes a share too
+        for (auto& t : pool) t.join();
+    };
+    runAll(countSlice);
+    runAll(reduceShard);
+
+    // 3) Concatenate and restore first-seen order (first indices are unique).
+    std::vector<Entry> all;
+    std::size_t total = 0;
+    for (const auto& s : shards) total += s.size();
+    all.reserve(total);
+    for (auto& s : shards) all.insert(all.end(), s.begin(), s.end());
+    std::sort(all.begin(), all.end(), [](const Entry& a, const Entry& b) { return a.first < b.first; });
+
+    std::vector<WordCount> out;
+    out.reserve(all.size());
+    for (const Entry& e : all) out.push_back({e.word, static_cast<std::size_t>(e.count)});
+    return out;
+}
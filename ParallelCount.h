@@ -0,0 +1,38 @@
+//
+// ParallelCount.h
+//
+// Multi-threaded word counting for token lists that are already in memory
+// (Scanner::tokenizeParallel / tokenizeMapped views).
+//
+// Sharded reduction, no locks:
+//   1) Each worker counts its own contiguous slice of the tokens into P private
+//      hash tables, one per shard; a word's shard is picked from its hash.
+//   2) Worker s then merges shard s of every worker's tables. Shards hold disjoint
+//      words, so the P merges run in parallel without touching each other.
+//   3) The shard results are concatenated and ordered by each word's first token
+//      position.
+//
+// The result is in first-seen order on purpose: feeding it to a FrequencyCounter
+// with insert(word, count) builds exactly the tree that inserting the tokens one
+// by one would have built (same node layout, same height), while the counter only
+// does V inserts instead of T.
+//
+
+#ifndef IMPLEMENTATION_PARALLELCOUNT_H
+#define IMPLEMENTATION_PARALLELCOUNT_H
+
+#pragma once
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+struct WordCount {
+    std::string_view word; // points into the caller's token storage
+    std::size_t count;
+};
+
+// Count 'tokens' on up to 'threads' workers (0 = all cores). Returns one entry per
+// distinct word, in order of first appearance. Small inputs use fewer threads.
+std::vector<WordCount> countParallel(const std::vector<std::string_view>& tokens, unsigned threads);
+
+#endif //IMPLEMENTATION_PARALLELCOUNT_H
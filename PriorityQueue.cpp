@@ -1,72 +1,134 @@
 // PriorityQueue.cpp
 #include "PriorityQueue.h"   // or whatever your header is named
 #include <algorithm>
+#include "CountingSort.h"
 #include <iomanip>
 #include <iostream>
 #include <vector>
 
-// ---- Assumed TreeNode (leaf) fields used by this PQ ----
-// For Part 2, PQ holds ONLY leaves, so we rely on:
-//   node->word      : std::string (the token string)
-//   node->key_word  : std::string (for ordering; for leaves it's == word)
-//   node->freq      : std::size_t (frequency)
-// Left/right pointers may exist but are unused here.
-
-PriorityQueue::PriorityQueue(std::vector<TreeNode*> nodes)
-: items_(std::move(nodes)) {
-    std::sort(items_.begin(), items_.end(),
-              [](const TreeNode* a, const TreeNode* b) { return higherPriority(a, b); });
-    // Optional: assert(isSorted());
+// ---- Assumed TreeNode fields used by this PQ ----
+//   node->word   : StringPool::Ref (the token string; leaves only, used by print)
+//   node->key    : std::uint32_t lexicographic rank (for ordering; see TreeNode.h)
+//   node->count  : std::size_t (frequency)
+// Child indices may exist but are unused here.
+
+PriorityQueue::PriorityQueue(std::vector<TreeNode*> nodes) {
+    heap_.reserve(nodes.size());
+    for (TreeNode* n : nodes) heap_.push_back({n->count, n->key, n});
+    // An array sorted in extraction order is already a valid heap, and sorting by
+    // (count, key) is linear here (see sortByPriority), so this beats a heapify.
+    sortByPriority(heap_);
+    std::reverse(heap_.begin(), heap_.end()); // (count desc, key asc) -> MIN first
+    sorted_ = true;
+    // Optional: assert(isHeap());
 }
 
 std::size_t PriorityQueue::size() const noexcept {
-    return items_.size();
+    return heap_.size();
 }
 bool PriorityQueue::empty() const noexcept {
-    return items_.empty();
+    return heap_.empty();
 }
 
 TreeNode* PriorityQueue::findMin() const noexcept {
-    return items_.empty() ? nullptr : items_.back();   // MIN at back (freq asc at back)
+    return heap_.empty() ? nullptr : heap_.front().node;   // MIN at the root
 }
 
 TreeNode* PriorityQueue::extractMin() noexcept {
-    if (items_.empty()) return nullptr;
-    TreeNode* min = items_.back();
-    items_.pop_back();
+    if (heap_.empty()) return nullptr;
+    TreeNode* min = heap_.front().node;
+    deleteMin();
     return min;
 }
 
 void PriorityQueue::deleteMin() noexcept {
-    if (!items_.empty()) items_.pop_back();
+    if (heap_.empty()) return;
+    // Move the last item to the root and let it sink.
+    sorted_ = false;
+    heap_.front() = heap_.back();
+    heap_.pop_back();
+    if (!heap_.empty()) siftDown(0);
 }
 
 void PriorityQueue::insert(TreeNode* node) {
-    // Keep items_ sorted by higherPriority (desc by freq, tie word asc).
-    auto before = [](const TreeNode* a, const TreeNode* b) {
-        return higherPriority(a, b);
-    };
-    auto pos = std::lower_bound(items_.begin(), items_.end(), node, before);
-    items_.insert(pos, node);
-    // Optional: assert(isSorted());
+    // Append as a new leaf of the heap and let it rise.
+    sorted_ = false;
+    heap_.push_back({node->count, node->key, node});
+    siftUp(heap_.size() - 1);
+    // Optional: assert(isHeap());
+}
+
+bool PriorityQueue::higherPriority(const Item& a, const Item& b) noexcept {
+    if (a.count != b.count) return a.count > b.count;     // higher freq first
+    return a.key < b.key;                                 // tie: lexicographic rank asc
+}
+
+void PriorityQueue::sortByPriority(std::vector<Item>& items) {
+    // Into (count desc, key asc) without comparisons: order by key first (skipped
+    // when the items are already in key order, which is how callers pass leaves),
+    // then a stable counting/radix sort by count keeps that order within each count.
+    auto keyOf = [](const Item& it) { return it.key; };
+    auto countOf = [](const Item& it) { return it.count; };
+    const bool keySorted = std::is_sorted(items.begin(), items.end(),
+                                          [](const Item& a, const Item& b) { return a.key < b.key; });
+    if (!keySorted) counting_sort::radixSort(items, keyOf, false);
+    counting_sort::sortByCountDesc(items, countOf);
+}
+
+void PriorityQueue::siftUp(std::size_t i) noexcept {
+    const Item item = heap_[i];
+    while (i > 0) {
+        const std::size_t parent = (i - 1) / kArity;
+        if (!extractsBefore(item, heap_[parent])) break;
+        heap_[i] = heap_[parent];
+        i = parent;
+    }
+    heap_[i] = item;
 }
 
-bool PriorityQueue::higherPriority(const TreeNode* a, const TreeNode* b) noexcept {
-    if (a->count != b->count) return a->count > b->count;     // higher freq first
-    return a->key_word < b->key_word;                     // tie: lexicographic asc
+void PriorityQueue::siftDown(std::size_t i) noexcept {
+    const Item item = heap_[i];
+    const std::size_t n = heap_.size();
+    for (;;) {
+        const std::size_t first = kArity * i + 1;
+        if (first >= n) break;
+
+        // Pick the child that comes out first.
+        const std::size_t last = std::min(first + kArity, n);
+        std::size_t best = first;
+        for (std::size_t c = first + 1; c < last; ++c) {
+            if (extractsBefore(heap_[c], heap_[best])) best = c;
+        }
+
+        if (!extractsBefore(heap_[best], item)) break;
+        heap_[i] = heap_[best];
+        i = best;
+    }
+    heap_[i] = item;
 }
 
-bool PriorityQueue::isSorted() const {
-    for (std::size_t i = 1; i < items_.size(); ++i) {
-        if (!higherPriority(items_[i-1], items_[i])) return false;
+bool PriorityQueue::isHeap() const {
+    for (std::size_t i = 1; i < heap_.size(); ++i) {
+        if (extractsBefore(heap_[i], heap_[(i - 1) / kArity])) return false;
     }
     return true;
 }
 
-void PriorityQueue::print(std::ostream& os) const {
+void PriorityQueue::print(const StringPool& words, std::ostream& os) const {
     // Emit .freq format per spec: right-justified freq in width 10, ONE space, then word, newline.
-    for (const auto* n : items_) {
-        // In Part 2, items are leaves: n->word is the token string.
-        os << std::setw(10) << n->count << ' ' << n->word << '\n';
+    auto emit = [&](const Item& it) {
+        // In Part 2, items are leaves: node->word references the token string.
+        os << std::setw(10) << it.count << ' ' << words.view(it.node->word) << '\n';
+    };
+
+    // Straight after construction (the .freq writer's case) heap_ is fully sorted in
+    // extraction order, so walk it backwards. Otherwise the heap is only partially
+    // ordered: print from a sorted copy.
+    if (sorted_) {
+        for (auto it = heap_.rbegin(); it != heap_.rend(); ++it) emit(*it);
+        return;
     }
+    std::vector<Item> sorted(heap_);
+    sortByPriority(sorted);
+    for (const Item& it : sorted) emit(it);
 }
@@ -4,20 +4,27 @@
 #ifndef IMPLEMENTATION_PRIORITYQUEUE_H
 #define IMPLEMENTATION_PRIORITYQUEUE_H
 // PriorityQueue.hpp
-// Vector-backed "priority queue" for Part 2.
-// Stores (word, count) pairs and maintains the invariant:
-//   higher frequency first (desc), tie -> word ascending (lexicographic).
+// Heap-backed priority queue of TreeNode* for the .freq writer and Huffman builds.
+// Ordering: higher frequency first (desc), tie -> key ascending (lexicographic rank).
+// The MIN is the lowest frequency, or the lexicographically last on a tie.
 //
 // Notes:
-// - Min element (smallest frequency, or lexicographically last on tie) sits at BACK after build().
-// - build() uses std::sort once; insert() re-inserts while preserving order (O(N)).
-// - writeFreq(os) emits lines per spec: setw(10) << count << ' ' << word << '\n'.
+// - 4-ary min-heap: O(N) build (counting/radix sort by count, see CountingSort.h),
+//   O(log N) insert/extractMin. Four children per node
+//   halves the tree depth of a binary heap, and the children of a node sit next to
+//   each other, so each sift-down step reads one or two cache lines.
+// - Each heap slot carries a copy of the node's (count, key), so comparisons never
+//   chase the TreeNode pointer.
+// - (count, key) is a strict total order over the queued nodes (keys are unique:
+//   each subtree's key is the rank of its own smallest leaf), so extraction order is
+//   exactly the order the old sorted-vector queue produced.
+// - print(words, os) emits lines per spec: setw(10) << count << ' ' << word << '\n'.
 //
-// This module does NOT own any TreeNodes (that’s for a later phase). It only
-// stores value pairs for the .freq artifact.
+// This module does NOT own any TreeNodes. It only stores non-owning pointers.
 
 #pragma once
 #include <cstddef>     // std::size_t
+#include <cstdint>     // std::uint32_t
 #include <iosfwd>      // std::ostream (forward decl)
 #include <string>      // std::string
 #include <vector>      // std::vector
@@ -27,33 +34,50 @@
 class PriorityQueue {
 public:
     // Non‑owning: does NOT delete the TreeNode* it stores.
-    // The constructor takes an initial set of leaves and sorts them internally.
+    // The constructor takes an initial set of leaves and heapifies them (O(N)).
     explicit PriorityQueue(std::vector<TreeNode*> nodes);
     ~PriorityQueue() = default;
 
     [[nodiscard]] std::size_t size() const noexcept;
     [[nodiscard]] bool empty() const noexcept;
 
-    // Min accessors (MIN = items_.back() under our ordering)
+    // Min accessors (MIN = heap_.front())
     [[nodiscard]] TreeNode* findMin() const noexcept;   // nullptr if empty
     TreeNode* extractMin() noexcept;                    // remove+return min, or nullptr
     void deleteMin() noexcept;                          // remove min if present
 
-    // Insert while maintaining the invariant (O(N) due to shifting)
+    // Insert while maintaining the heap invariant (O(log N)).
     // Stores the pointer without taking ownership.
     void insert(TreeNode* node);
 
-    // Debug printing
-    void print(std::ostream& os = std::cout) const;
+    // Debug printing / .freq writer, in priority order (count desc, key asc).
+    // Sorts a copy of the heap; the queue itself is unchanged. Leaves reference their
+    // word through 'words' (the StringPool the leaves were built with).
+    void print(const StringPool& words, std::ostream& os = std::cout) const;
 
 private:
-    // Invariant: items_ is kept sorted by HigherPriority(a,b)
-    // i.e., (freq desc, key_word asc). Therefore the MIN is items_.back().
-    // Ownership: items_ does NOT own the pointers.
-    std::vector<TreeNode*> items_;
+    struct Item {
+        std::size_t count;   // copy of node->count
+        std::uint32_t key;   // copy of node->key
+        TreeNode* node;
+    };
 
-    static bool higherPriority(const TreeNode* a, const TreeNode* b) noexcept; // a before b?
-    bool isSorted() const; // for assertions/tests only
+    static constexpr std::size_t kArity = 4;
+
+    // Invariant: heap_ is a 4-ary min-heap under extractsBefore(a,b), i.e. every
+    // parent comes out before its children; children of i are kArity*i+1 .. kArity*i+kArity.
+    // 'key' is the node's lexicographic rank (see TreeNode), so the order is the same
+    // as (freq desc, key_word asc) without any string comparison.
+    // Ownership: heap_ does NOT own the pointers.
+    std::vector<Item> heap_;
+    bool sorted_ = false; // heap_ is fully sorted in extraction order (until the first insert/extract)
+
+    static bool higherPriority(const Item& a, const Item& b) noexcept; // a before b in .freq order?
+    static bool extractsBefore(const Item& a, const Item& b) noexcept { return higherPriority(b, a); }
+    static void sortByPriority(std::vector<Item>& items); // -> (count desc, key asc)
+    void siftUp(std::size_t i) noexcept;
+    void siftDown(std::size_t i) noexcept;
+    bool isHeap() const; // for assertions/tests only
 };
 
 
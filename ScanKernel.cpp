@@ -0,0 +1,201 @@
+//
+// ScanKernel.cpp
+//
+// Letter test used by every path: fold bit 0x20 (A–Z -> a–z), then range-check a–z.
+// In SIMD form the range check is a single signed compare after biasing the
+// range onto [-128, -103], which avoids the missing unsigned byte compare in SSE2.
+//
+
+#include "ScanKernel.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define SCAN_KERNEL_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+    // ---------- Scalar fallback ----------
+
+    inline bool isLetter(char c) noexcept {
+        return static_cast<unsigned char>((static_cast<unsigned char>(c) | 0x20) - 'a') < 26;
+    }
+
+    inline bool isUpper(char c) noexcept {
+        return static_cast<unsigned char>(static_cast<unsigned char>(c) - 'A') < 26;
+    }
+
+    const char* findLetterScalar(const char* p, const char* last) noexcept {
+        while (p != last && !isLetter(*p)) ++p;
+        return p;
+    }
+
+    const char* findNonLetterScalar(const char* p, const char* last, bool& sawUpper) noexcept {
+        bool upper = false;
+        while (p != last && isLetter(*p)) {
+            upper |= isUpper(*p);
+            ++p;
+        }
+        if (upper) sawUpper = true;
+        return p;
+    }
+
+    void lowercaseCopyScalar(char* dst, const char* src, std::size_t n) noexcept {
+        for (std::size_t i = 0; i < n; ++i) {
+            const char c = src[i];
+            dst[i] = isUpper(c) ? static_cast<char>(c | 0x20) : c;
+        }
+    }
+
+#ifdef SCAN_KERNEL_X86
+
+    // ---------- SSE2: 16 bytes per step ----------
+
+    inline __m128i letterMask16(__m128i v) noexcept {
+        const __m128i folded = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        const __m128i biased = _mm_add_epi8(folded, _mm_set1_epi8(static_cast<char>(128 - 'a')));
+        return _mm_cmplt_epi8(biased, _mm_set1_epi8(static_cast<char>(-128 + 26)));
+    }
+
+    inline __m128i upperMask16(__m128i v) noexcept {
+        const __m128i biased = _mm_add_epi8(v, _mm_set1_epi8(static_cast<char>(128 - 'A')));
+        return _mm_cmplt_epi8(biased, _mm_set1_epi8(static_cast<char>(-128 + 26)));
+    }
+
+    const char* findLetterSse2(const char* p, const char* last) noexcept {
+        while (last - p >= 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const unsigned letters = static_cast<unsigned>(_mm_movemask_epi8(letterMask16(v)));
+            if (letters) return p + __builtin_ctz(letters);
+            p += 16;
+        }
+        return findLetterScalar(p, last);
+    }
+
+    const char* findNonLetterSse2(const char* p, const char* last, bool& sawUpper) noexcept {
+        while (last - p >= 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const unsigned others = ~static_cast<unsigned>(_mm_movemask_epi8(letterMask16(v))) & 0xFFFFu;
+            const unsigned upper = static_cast<unsigned>(_mm_movemask_epi8(upperMask16(v)));
+            if (others) {
+                const unsigned k = static_cast<unsigned>(__builtin_ctz(others));
+                if (upper & ((1u << k) - 1u)) sawUpper = true;
+                return p + k;
+            }
+            if (upper) sawUpper = true;
+            p += 16;
+        }
+        return findNonLetterScalar(p, last, sawUpper);
+    }
+
+    void lowercaseCopySse2(char* dst, const char* src, std::size_t n) noexcept {
+        std::size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            const __m128i bit = _mm_and_si128(upperMask16(v), _mm_set1_epi8(0x20));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(v, bit));
+        }
+        lowercaseCopyScalar(dst + i, src + i, n - i);
+    }
+
+    // ---------- AVX2: 32 bytes per step (selected at runtime) ----------
+
+    __attribute__((target("avx2")))
+    inline __m256i letterMask32(__m256i v) noexcept {
+        const __m256i folded = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+        const __m256i biased = _mm256_add_epi8(folded, _mm256_set1_epi8(static_cast<char>(128 - 'a')));
+        return _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(-128 + 26)), biased);
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256i upperMask32(__m256i v) noexcept {
+        const __m256i biased = _mm256_add_epi8(v, _mm256_set1_epi8(static_cast<char>(128 - 'A')));
+        return _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(-128 + 26)), biased);
+    }
+
+    __attribute__((target("avx2")))
+    const char* findLetterAvx2(const char* p, const char* last) noexcept {
+        while (last - p >= 32) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            const unsigned letters = static_cast<unsigned>(_mm256_movemask_epi8(letterMask32(v)));
+            if (letters) return p + __builtin_ctz(letters);
+            p += 32;
+        }
+        return findLetterSse2(p, last);
+    }
+
+    __attribute__((target("avx2")))
+    const char* findNonLetterAvx2(const char* p, const char* last, bool& sawUpper) noexcept {
+        while (last - p >= 32) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            const unsigned others = ~static_cast<unsigned>(_mm256_movemask_epi8(letterMask32(v)));
+            const unsigned upper = static_cast<unsigned>(_mm256_movemask_epi8(upperMask32(v)));
+            if (others) {
+                const unsigned k = static_cast<unsigned>(__builtin_ctz(others));
+                if (upper & ((1u << k) - 1u)) sawUpper = true;
+                return p + k;
+            }
+            if (upper) sawUpper = true;
+            p += 32;
+        }
+        return findNonLetterSse2(p, last, sawUpper);
+    }
+
+    __attribute__((target("avx2")))
+    void lowercaseCopyAvx2(char* dst, const char* src, std::size_t n) noexcept {
+        std::size_t i = 0;
+        for (; i + 32 <= n; i += 32) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            const __m256i bit = _mm256_and_si256(upperMask32(v), _mm256_set1_epi8(0x20));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_or_si256(v, bit));
+        }
+        lowercaseCopySse2(dst + i, src + i, n - i);
+    }
+
+#endif // SCAN_KERNEL_X86
+
+    // ---------- Runtime dispatch ----------
+
+    struct Kernels {
+        const char* (*findLetter)(const char*, const char*) noexcept;
+        const char* (*findNonLetter)(const char*, const char*, bool&) noexcept;
+        void (*lowercaseCopy)(char*, const char*, std::size_t) noexcept;
+        const char* name;
+    };
+
+    Kernels selectKernels() noexcept {
+#ifdef SCAN_KERNEL_X86
+        if (__builtin_cpu_supports("avx2")) {
+            return {findLetterAvx2, findNonLetterAvx2, lowercaseCopyAvx2, "avx2"};
+        }
+        return {findLetterSse2, findNonLetterSse2, lowercaseCopySse2, "sse2"};
+#else
+        return {findLetterScalar, findNonLetterScalar, lowercaseCopyScalar, "scalar"};
+#endif
+    }
+
+    const Kernels& active() noexcept {
+        static const Kernels k = selectKernels(); // picked once, on first use
+        return k;
+    }
+}
+
+namespace scan_kernel {
+
+    const char* findLetter(const char* p, const char* last) noexcept {
+        return active().findLetter(p, last);
+    }
+
+    const char* findNonLetter(const char* p, const char* last, bool& sawUpper) noexcept {
+        return active().findNonLetter(p, last, sawUpper);
+    }
+
+    void lowercaseCopy(char* dst, const char* src, std::size_t n) noexcept {
+        active().lowercaseCopy(dst, src, n);
+    }
+
+    const char* implementationName() noexcept {
+        return active().name;
+    }
+
+}
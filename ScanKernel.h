@@ -0,0 +1,37 @@
+//
+// ScanKernel.h
+//
+// Character-class kernels behind Scanner's buffer tokenizer.
+// Each kernel classifies a whole vector of bytes per step instead of branching on
+// every character:
+//   - SSE2 (16 bytes/step) is the default on x86,
+//   - AVX2 (32 bytes/step) is picked at runtime when the CPU supports it,
+//   - a scalar fallback is used everywhere else.
+// All three implement the same rules: a "letter" is ASCII A–Z or a–z; everything
+// else (apostrophes included) is left for Scanner to decide on.
+//
+
+#ifndef IMPLEMENTATION_SCANKERNEL_H
+#define IMPLEMENTATION_SCANKERNEL_H
+
+#pragma once
+#include <cstddef>
+
+namespace scan_kernel {
+
+    // First ASCII letter in [p, last), or last if there is none.
+    const char* findLetter(const char* p, const char* last) noexcept;
+
+    // First byte in [p, last) that is NOT an ASCII letter, or last.
+    // Sets 'sawUpper' if any byte in the skipped run is A–Z (left untouched otherwise).
+    const char* findNonLetter(const char* p, const char* last, bool& sawUpper) noexcept;
+
+    // dst[i] = tolower(src[i]) for ASCII A–Z; every other byte is copied unchanged.
+    void lowercaseCopy(char* dst, const char* src, std::size_t n) noexcept;
+
+    // Name of the implementation selected for this CPU ("avx2", "sse2" or "scalar").
+    const char* implementationName() noexcept;
+
+}
+
+#endif //IMPLEMENTATION_SCANKERNEL_H
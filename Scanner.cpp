@@ -8,28 +8,37 @@
 #include <iostream>
 #include <fstream>
 #include <cctype>
+#include <algorithm>
+#include <cstring>
+#include <thread>
 
 #include "utils.hpp"
+#include "ScanKernel.h"
+
+namespace {
+    // Lowercased tokens are packed into blocks of this size.
+    constexpr std::size_t kArenaBlockSize = 64 * 1024;
+
+    // Below this many bytes per chunk, tokenizeParallel() stops adding threads.
+    constexpr std::size_t kMinChunkBytes = 256 * 1024;
+
+    // forEachToken() reads the input this many bytes at a time.
+    constexpr std::size_t kStreamBlockBytes = 1024 * 1024;
+
+    inline bool isAsciiLetter(char c) noexcept {
+        // Folding bit 0x20 maps 'A'..'Z' onto 'a'..'z' and leaves the range check to one compare.
+        return static_cast<unsigned char>((static_cast<unsigned char>(c) | 0x20) - 'a') < 26;
+    }
+}
 
 Scanner::Scanner(std::filesystem::path inputPath) : inputPath_(std::move(inputPath)) {
     // Store the input file path for later use in tokenize()
 }
 
 error_type Scanner::tokenize(std::vector<std::string>& words) {
-    // Open the input file
-    std::ifstream infile(inputPath_);
-    if (!infile.is_open()) {
-        return UNABLE_TO_OPEN_FILE;
-    }
-
-    // Read tokens until EOF
-    std::string token;
-    while (!(token = readWord(infile)).empty()) {
-        words.push_back(token);
-    }
-
-    infile.close();
-    return NO_ERROR;
+    // Same block reader and SIMD kernel as the streaming mode; each token is copied
+    // out because the sink's view dies with the block.
+    return forEachToken([&words](std::string_view t) { words.emplace_back(t); });
 }
 
 error_type Scanner::tokenize(std::vector<std::string>& words,
@@ -44,64 +53,239 @@ error_type Scanner::tokenize(std::vector<std::string>& words,
     return writeVectorToFile(outputFile.string(), words);
 }
 
-std::string Scanner::readWord(std::istream& in) {
-    std::string token;
-    int ch;
-    
-    // Skip separators until we find a letter or EOF
-    while ((ch = in.get()) != EOF) {
-        // Convert to lowercase if it's an ASCII letter
-        if (ch >= 'A' && ch <= 'Z') {
-            ch = ch + ('a' - 'A');
-        }
-        
-        // Check if it's a lowercase letter (start of token)
-        if (ch >= 'a' && ch <= 'z') {
-            token += static_cast<char>(ch);
-            break;
-        }
-        // Otherwise it's a separator, keep skipping
-    }
-    
-    // If we hit EOF without finding a letter, return empty string
-    if (token.empty()) {
-        return "";
-    }
-    
-    // Continue reading the token
-    while ((ch = in.get()) != EOF) {
-        // Convert to lowercase if uppercase ASCII letter
-        if (ch >= 'A' && ch <= 'Z') {
-            ch = ch + ('a' - 'A');
+error_type Scanner::tokenizeMapped(std::vector<std::string_view>& words) {
+    if (error_type err = mapInput(1); err != NO_ERROR) {
+        return err;
+    }
+
+    const char* first = mapped_.data();
+    const char* last = first + mapped_.size();
+    scanRange(first, last, last, arenas_.front(), words);
+    return NO_ERROR;
+}
+
+error_type Scanner::tokenizeMapped(std::vector<std::string_view>& words,
+                                   const std::filesystem::path& outputFile) {
+    error_type result = tokenizeMapped(words);
+    if (result != NO_ERROR) {
+        return result;
+    }
+    return writeVectorToFile(outputFile.string(), words);
+}
+
+error_type Scanner::tokenizeParallel(std::vector<std::string_view>& words, unsigned threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    if (error_type err = mapInput(threads); err != NO_ERROR) {
+        return err;
+    }
+
+    const char* begin = mapped_.data();
+    const char* last = begin + mapped_.size();
+
+    // Small inputs are not worth a thread per core.
+    const std::size_t chunks = std::clamp<std::size_t>(mapped_.size() / kMinChunkBytes, 1, threads);
+    if (chunks == 1) {
+        scanRange(begin, last, last, arenas_.front(), words);
+        return NO_ERROR;
+    }
+
+    // Each chunk scans into its own list with its own arena; lists are joined in order.
+    const std::size_t step = mapped_.size() / chunks;
+    std::vector<std::vector<std::string_view>> parts(chunks);
+    std::vector<std::thread> workers;
+    workers.reserve(chunks);
+    for (std::size_t i = 0; i < chunks; ++i) {
+        const char* lo = begin + i * step;
+        const char* hi = (i + 1 == chunks) ? last : lo + step;
+        workers.emplace_back([this, &parts, i, begin, lo, hi, last] {
+            scanRange(alignToTokenStart(begin, lo, last), hi, last, arenas_[i], parts[i]);
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    std::size_t total = words.size();
+    for (const auto& part : parts) total += part.size();
+    words.reserve(total);
+    for (const auto& part : parts) words.insert(words.end(), part.begin(), part.end());
+    return NO_ERROR;
+}
+
+error_type Scanner::tokenizeParallel(std::vector<std::string_view>& words,
+                                     const std::filesystem::path& outputFile,
+                                     unsigned threads) {
+    error_type result = tokenizeParallel(words, threads);
+    if (result != NO_ERROR) {
+        return result;
+    }
+    return writeVectorToFile(outputFile.string(), words);
+}
+
+error_type Scanner::tokenizeSymbols(SymbolTable& symbols, std::vector<std::uint32_t>& ids) {
+    if (error_type err = mapInput(0); err != NO_ERROR) {
+        return err;
+    }
+
+    const char* cursor = mapped_.data();
+    const char* last = cursor + mapped_.size();
+    std::string lowered; // scratch; interned words are copied into the table's pool
+    RawToken tok{};
+    while (nextToken(cursor, last, tok)) {
+        if (tok.hasUpper) {
+            lowered.resize(tok.size);
+            scan_kernel::lowercaseCopy(lowered.data(), tok.first, tok.size);
+            ids.push_back(symbols.intern(lowered));
+        } else {
+            ids.push_back(symbols.intern(std::string_view(tok.first, tok.size)));
         }
-        
-        // If it's a letter, add it
-        if (ch >= 'a' && ch <= 'z') {
-            token += static_cast<char>(ch);
+    }
+
+    // The IDs do not point into the mapping, so it can go right away.
+    mapped_.close();
+    return NO_ERROR;
+}
+
+error_type Scanner::tokenizeSymbols(SymbolTable& symbols, std::vector<std::uint32_t>& ids,
+                                    const std::filesystem::path& outputFile) {
+    error_type result = tokenizeSymbols(symbols, ids);
+    if (result != NO_ERROR) {
+        return result;
+    }
+
+    std::ofstream out(outputFile, std::ios::out | std::ios::trunc);
+    if (!out.is_open()) {
+        return UNABLE_TO_OPEN_FILE_FOR_WRITING;
+    }
+    for (const std::uint32_t id : ids) {
+        out << symbols.word(id) << '\n';
+    }
+    return out ? NO_ERROR : FAILED_TO_WRITE_FILE;
+}
+
+error_type Scanner::forEachToken(const TokenSink& sink) const {
+    std::ifstream infile(inputPath_, std::ios::binary);
+    if (!infile.is_open()) {
+        return UNABLE_TO_OPEN_FILE;
+    }
+
+    std::vector<char> block(kStreamBlockBytes);
+    std::string lowered; // scratch for tokens that need lowercasing
+    std::size_t carry = 0; // bytes of an unfinished token moved to the front of 'block'
+
+    for (;;) {
+        infile.read(block.data() + carry, static_cast<std::streamsize>(block.size() - carry));
+        const std::size_t got = static_cast<std::size_t>(infile.gcount());
+        const bool atEnd = infile.eof();
+        if (!atEnd && infile.fail()) return UNABLE_TO_OPEN_FILE;
+
+        const char* first = block.data();
+        const char* last = first + carry + got;
+
+        // Until EOF, hold back a trailing run that may be cut mid-token (or right
+        // at an apostrophe whose peek needs the next block).
+        const char* stop = atEnd ? last : trailingRunStart(first, last);
+        if (stop == first && !atEnd) {
+            // One run fills the whole block: grow it and keep reading.
+            carry = block.size();
+            block.resize(block.size() * 2);
+            continue;
         }
-        // If it's an apostrophe, peek ahead
-        else if (ch == '\'') {
-            // Peek at the next character
-            int next = in.peek();
-            
-            // Convert next to lowercase if uppercase
-            if (next >= 'A' && next <= 'Z') {
-                next = next + ('a' - 'A');
-            }
-            
-            // If next is a letter, include apostrophe and continue
-            if (next >= 'a' && next <= 'z') {
-                token += '\'';
+
+        RawToken tok{};
+        const char* cursor = first;
+        while (nextToken(cursor, stop, tok)) {
+            if (tok.hasUpper) {
+                lowered.resize(tok.size);
+                scan_kernel::lowercaseCopy(lowered.data(), tok.first, tok.size);
+                sink(lowered);
             } else {
-                // Apostrophe not followed by letter, end token
-                break;
+                sink(std::string_view(tok.first, tok.size));
             }
         }
-        // Any other character is a separator, end token
-        else {
-            break;
+
+        if (atEnd) break;
+        carry = static_cast<std::size_t>(last - stop);
+        std::memmove(block.data(), stop, carry);
+    }
+    return NO_ERROR;
+}
+
+const char* Scanner::trailingRunStart(const char* first, const char* last) noexcept {
+    const char* p = last;
+    while (p != first && (isAsciiLetter(p[-1]) || p[-1] == '\'')) --p;
+    return p;
+}
+
+error_type Scanner::mapInput(std::size_t arenaCount) {
+    arenas_.clear();
+    arenas_.resize(arenaCount);
+    return mapped_.open(inputPath_);
+}
+
+void Scanner::scanRange(const char* first, const char* stop, const char* last,
+                        TokenArena& arena, std::vector<std::string_view>& out) {
+    RawToken tok{};
+    while (nextToken(first, last, tok) && tok.first < stop) {
+        if (tok.hasUpper) out.push_back(arena.lower(tok));
+        else              out.emplace_back(tok.first, tok.size);
+    }
+}
+
+const char* Scanner::alignToTokenStart(const char* begin, const char* p, const char* last) noexcept {
+    // Find the first letter at or after p; only a letter can start or continue a token.
+    const char* q = scan_kernel::findLetter(p, last);
+    if (q == last || q == begin) return q;
+
+    // q continues an earlier token if it directly follows a letter, or follows an
+    // apostrophe that itself follows a letter (the "a'b" case cut right at the ').
+    const bool continues = isAsciiLetter(q[-1]) ||
+                           (q[-1] == '\'' && q - 1 != begin && isAsciiLetter(q[-2]));
+    if (!continues) return q;
+
+    // Skip the remainder of that token; it belongs to the previous chunk.
+    // (The next letter after it is preceded by a separator, so it cannot continue anything.)
+    RawToken tok{};
+    nextToken(q, last, tok);
+    return q;
+}
+
+bool Scanner::nextToken(const char*& cursor, const char* last, RawToken& tok) noexcept {
+    // Skip separators until we find a letter or the end of the buffer
+    const char* p = scan_kernel::findLetter(cursor, last);
+    if (p == last) {
+        cursor = p;
+        return false;
+    }
+
+    // Consume runs of letters; an apostrophe joins two runs only when a letter
+    // follows it. Anything else ends the token and is skipped by the next call.
+    const char* first = p;
+    bool hasUpper = false;
+    for (;;) {
+        p = scan_kernel::findNonLetter(p, last, hasUpper);
+        if (p != last && *p == '\'' && p + 1 != last && isAsciiLetter(p[1])) {
+            ++p;
+            continue;
         }
+        break;
     }
-    
-    return token;
+
+    tok = RawToken{first, static_cast<std::size_t>(p - first), hasUpper};
+    cursor = p;
+    return true;
+}
+
+std::string_view Scanner::TokenArena::lower(const RawToken& tok) {
+    if (tok.size > left_) {
+        const std::size_t blockSize = std::max(kArenaBlockSize, tok.size);
+        blocks_.push_back(std::make_unique<char[]>(blockSize));
+        next_ = blocks_.back().get();
+        left_ = blockSize;
+    }
+
+    char* out = next_;
+    scan_kernel::lowercaseCopy(out, tok.first, tok.size);
+    next_ += tok.size;
+    left_ -= tok.size;
+    return {out, tok.size};
 }
@@ -5,13 +5,21 @@
 #ifndef IMPLEMENTATION_FILETOWORDS_HPP
 #define IMPLEMENTATION_FILETOWORDS_HPP
 #include <string>
+#include <string_view>
 #include <vector>
+#include <memory>
+#include <functional>
 #include <filesystem>
 
 #include "utils.hpp"
+#include "MappedFile.h"
+#include "SymbolTable.h"
 
 class Scanner {
 public:
+    // Receives each token in input order. The view is only valid during the call.
+    using TokenSink = std::function<void(std::string_view)>;
+
     explicit Scanner(std::filesystem::path inputPath);
 
     // Tokenize into memory (according to the Rules in this section).
@@ -22,15 +30,85 @@ public:
     error_type tokenize(std::vector<std::string>& words,
                         const std::filesystem::path& outputFile);
 
+    // Zero-copy tokenize: memory-maps the input and returns every token as a view.
+    // Tokens that are already lowercase point straight into the mapping; tokens with
+    // uppercase letters are lowercased into an arena owned by this Scanner.
+    // The views stay valid for as long as this Scanner is alive (and not re-tokenized).
+    error_type tokenizeMapped(std::vector<std::string_view>& words);
+    error_type tokenizeMapped(std::vector<std::string_view>& words,
+                              const std::filesystem::path& outputFile);
+
+    // Parallel zero-copy tokenize: splits the mapping into one byte range per thread
+    // (threads == 0 → hardware concurrency) and tokenizes the ranges concurrently.
+    // A token cut by a range boundary is owned by the range it starts in, so the joined
+    // result is identical, in order, to tokenizeMapped(). Same view lifetime rules.
+    error_type tokenizeParallel(std::vector<std::string_view>& words, unsigned threads = 0);
+    error_type tokenizeParallel(std::vector<std::string_view>& words,
+                                const std::filesystem::path& outputFile,
+                                unsigned threads = 0);
+
+    // Interning tokenize: each token becomes the dense symbol ID 'symbols' assigns it
+    // (first-seen order), so later stages can work on integers instead of strings.
+    // The output-file overload writes the same .tokens text as tokenize().
+    error_type tokenizeSymbols(SymbolTable& symbols, std::vector<std::uint32_t>& ids);
+    error_type tokenizeSymbols(SymbolTable& symbols, std::vector<std::uint32_t>& ids,
+                               const std::filesystem::path& outputFile);
+
+    // Streaming tokenize: reads the input in fixed-size blocks and pushes every token
+    // into 'sink' without materializing a token list, so memory stays bounded by the
+    // block size no matter how large the input is. Call again to re-scan (second pass).
+    error_type forEachToken(const TokenSink& sink) const;
+
     ~Scanner() = default;
 
 private:
-    // Read the next token from 'in'. Returns empty string when no more tokens.
-    // Follows the project’s tokenization rules: letters a–z with optional internal apostrophes;
-    // digits, punctuation, hyphens/dashes, whitespace, and non‑ASCII are separators.
-    static std::string readWord(std::istream& in);
+    // A token as it appears in the raw input: [first, first + size).
+    // hasUpper tells the caller whether it still needs lowercasing.
+    struct RawToken {
+        const char* first;
+        std::size_t size;
+        bool hasUpper;
+    };
+
+    // Find the next token in [cursor, last) and advance 'cursor' past it. Returns false
+    // when no more tokens remain. Follows the project’s tokenization rules: letters a–z
+    // with optional internal apostrophes; digits, punctuation, hyphens/dashes,
+    // whitespace, and non‑ASCII are separators.
+    static bool nextToken(const char*& cursor, const char* last, RawToken& tok) noexcept;
+
+    // Bump allocator for lowercased token copies (one per tokenizing thread).
+    class TokenArena {
+    public:
+        // Copy 'tok' lowercased into the arena and return a view of the copy.
+        std::string_view lower(const RawToken& tok);
+    private:
+        std::vector<std::unique_ptr<char[]>> blocks_;
+        char* next_ = nullptr;
+        std::size_t left_ = 0;
+    };
+
+    // Append every token that STARTS in [first, stop) to 'out'. A token may run past
+    // 'stop' (up to 'last'), which is how tokens cut by a chunk boundary are repaired.
+    // 'first' must not be in the middle of a token.
+    static void scanRange(const char* first, const char* stop, const char* last,
+                          TokenArena& arena, std::vector<std::string_view>& out);
+
+    // First position >= p where a token could start: if p lands inside a token that
+    // began before it (letters or an internal apostrophe), skip the rest of that token.
+    static const char* alignToTokenStart(const char* begin, const char* p, const char* last) noexcept;
+
+    // Start of the trailing [A-Za-z'] run in [first, last): a token that may continue
+    // into the next block. Everything before it is complete.
+    static const char* trailingRunStart(const char* first, const char* last) noexcept;
+
+    // Map the input and reset the arenas; invalidates views from earlier calls.
+    error_type mapInput(std::size_t arenaCount);
 
     std::filesystem::path inputPath_;
+
+    // Zero-copy mode state: the mapping plus the arenas for lowercased tokens.
+    MappedFile mapped_;
+    std::vector<TokenArena> arenas_;
 };
 
 #endif //IMPLEMENTATION_FILETOWORDS_HPP
\ No newline at end of file
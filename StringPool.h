@@ -0,0 +1,44 @@
+//
+// StringPool.h
+//
+// Append-only character pool shared by the nodes of one tree.
+// A word is stored once and referenced by a 32-bit (offset, length) pair instead
+// of a std::string per node, which keeps nodes small and trivially destructible.
+// Limit: 4 GiB of distinct-word bytes per pool.
+//
+
+#ifndef IMPLEMENTATION_STRINGPOOL_H
+#define IMPLEMENTATION_STRINGPOOL_H
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+class StringPool {
+public:
+    struct Ref {
+        std::uint32_t offset = 0;
+        std::uint32_t length = 0;
+    };
+
+    // Copy 's' into the pool and return its reference.
+    Ref add(std::string_view s) {
+        const Ref r{static_cast<std::uint32_t>(chars_.size()), static_cast<std::uint32_t>(s.size())};
+        chars_.append(s);
+        return r;
+    }
+
+    [[nodiscard]] std::string_view view(Ref r) const noexcept {
+        return {chars_.data() + r.offset, r.length};
+    }
+
+    void reserve(std::size_t bytes) { chars_.reserve(bytes); }
+    [[nodiscard]] std::size_t bytes() const noexcept { return chars_.size(); }
+
+private:
+    std::string chars_;
+};
+
+#endif //IMPLEMENTATION_STRINGPOOL_H
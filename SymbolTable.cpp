@@ -0,0 +1,66 @@
+//
+// SymbolTable.cpp
+//
+
+#include "SymbolTable.h"
+
+#include "WordHash.h"
+
+namespace {
+    constexpr std::size_t kInitialSlots = 1024;
+}
+
+SymbolTable::SymbolTable()
+    : slots_(kInitialSlots, Slot{0, kNoSymbol}), offsets_{0} {}
+
+std::uint32_t SymbolTable::intern(std::string_view w) {
+    const std::uint32_t h = wordHash(w);
+    const std::size_t mask = slots_.size() - 1;
+
+    for (std::size_t i = h & mask;; i = (i + 1) & mask) {
+        Slot& s = slots_[i];
+        if (s.id == kNoSymbol) {
+            // New word: append to the pool and claim this slot.
+            const auto id = static_cast<std::uint32_t>(size());
+            chars_.append(w);
+            offsets_.push_back(chars_.size());
+            s = Slot{h, id};
+            if (2 * size() > slots_.size()) grow();
+            return id;
+        }
+        if (s.hash == h && word(s.id) == w) return s.id;
+    }
+}
+
+std::uint32_t SymbolTable::find(std::string_view w) const noexcept {
+    const std::uint32_t h = wordHash(w);
+    const std::size_t mask = slots_.size() - 1;
+
+    for (std::size_t i = h & mask;; i = (i + 1) & mask) {
+        const Slot& s = slots_[i];
+        if (s.id == kNoSymbol) return kNoSymbol;
+        if (s.hash == h && word(s.id) == w) return s.id;
+    }
+}
+
+std::string_view SymbolTable::word(std::uint32_t id) const noexcept {
+    return std::string_view(chars_).substr(offsets_[id], offsets_[id + 1] - offsets_[id]);
+}
+
+std::size_t SymbolTable::size() const noexcept {
+    return offsets_.size() - 1;
+}
+
+void SymbolTable::grow() {
+    // Double the slot array and re-place every slot from its stored hash;
+    // the word pool itself does not move.
+    std::vector<Slot> old(slots_.size() * 2, Slot{0, kNoSymbol});
+    old.swap(slots_);
+    const std::size_t mask = slots_.size() - 1;
+    for (const Slot& s : old) {
+        if (s.id == kNoSymbol) continue;
+        std::size_t i = s.hash & mask;
+        while (slots_[i].id != kNoSymbol) i = (i + 1) & mask;
+        slots_[i] = s;
+    }
+}
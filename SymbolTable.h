@@ -0,0 +1,54 @@
+//
+// SymbolTable.h
+//
+// Interning dictionary: maps each distinct word to a dense uint32_t symbol ID,
+// assigned in first-seen order (0, 1, 2, ...). Later stages can then count and
+// encode on integer arrays and only touch the strings when writing output.
+//
+// - Open addressing (linear probing) over a power-of-two slot array; each slot keeps
+//   the word's 32-bit hash so most mismatches are rejected without a string compare
+//   and growing never re-hashes a string.
+// - Word bytes live back to back in one pool; no per-word heap allocation.
+//
+
+#ifndef IMPLEMENTATION_SYMBOLTABLE_H
+#define IMPLEMENTATION_SYMBOLTABLE_H
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class SymbolTable {
+public:
+    static constexpr std::uint32_t kNoSymbol = UINT32_MAX;
+
+    SymbolTable();
+
+    // ID of 'word', adding it (with the next free ID) the first time it is seen.
+    std::uint32_t intern(std::string_view word);
+
+    // ID of 'word', or kNoSymbol if it was never interned. No side effects.
+    [[nodiscard]] std::uint32_t find(std::string_view word) const noexcept;
+
+    // The word behind an ID (valid for as long as the table is).
+    [[nodiscard]] std::string_view word(std::uint32_t id) const noexcept;
+
+    [[nodiscard]] std::size_t size() const noexcept; // distinct words
+
+private:
+    struct Slot {
+        std::uint32_t hash; // wordHash(word)
+        std::uint32_t id;   // kNoSymbol = empty slot
+    };
+
+    std::vector<Slot> slots_;            // size is a power of two, at most half full
+    std::string chars_;                  // all words, back to back
+    std::vector<std::uint64_t> offsets_; // word i = chars_[offsets_[i], offsets_[i+1])
+
+    void grow();
+};
+
+#endif //IMPLEMENTATION_SYMBOLTABLE_H
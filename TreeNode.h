@@ -2,29 +2,42 @@
 // Created by Caleb Clements on 10/17/25.
 //
 #pragma once
-#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include "StringPool.h"
 
 #ifndef IMPLEMENTATION_TREENODE_H
 #define IMPLEMENTATION_TREENODE_H
 
+// Compact node shared by BST and HuffmanTree (32 bytes, trivially destructible).
+// - Children are 32-bit indices into the owning tree's node vector (kNoNode = none).
+// - The word is an (offset, length) reference into the owning tree's StringPool.
+// - The Huffman tie-break key is an integer rank instead of a copied string:
+//   leaves are numbered in lexicographic word order, so comparing ranks gives the
+//   same answer as comparing words. Internal nodes take the smaller child rank
+//   (= the rank of the lexicographically smallest leaf below them).
 struct TreeNode {
-    std::string word;
-    std::string key_word;
-    size_t count = 1;
-    TreeNode* left = nullptr;
-    TreeNode* right = nullptr;
+    static constexpr std::uint32_t kNoNode = UINT32_MAX;
+
+    std::size_t count = 1;
+    std::uint32_t key = 0;          // tie-break rank (see above); unused by BST
+    std::uint32_t left = kNoNode;
+    std::uint32_t right = kNoNode;
+    StringPool::Ref word;           // empty for internal nodes
 
     // Leaf
-    explicit TreeNode(std::string w, std::size_t f=1)
-        : word(std::move(w)), key_word(word), count(f) {}
+    TreeNode(StringPool::Ref w, std::size_t f, std::uint32_t rank = 0)
+        : count(f), key(rank), word(w) {}
 
     // Internal
-    // FOR USE IN BUILDING OF HUFFMAN TREE (PART 3)
-    TreeNode(TreeNode* L, TreeNode* R)
-        : word(""),
-          key_word(std::min(L->key_word, R->key_word)),
-          count(L->count + R->count),
+    // FOR USE IN BUILDING OF HUFFMAN TREE (PART 3): L and R are the children's indices.
+    TreeNode(std::uint32_t L, const TreeNode& l, std::uint32_t R, const TreeNode& r)
+        : count(l.count + r.count),
+          key(std::min(l.key, r.key)),
           left(L), right(R) {}
+
+    [[nodiscard]] bool isLeaf() const noexcept { return left == kNoNode && right == kNoNode; }
 };
 
-#endif //IMPLEMENTATION_TREENODE_H
\ No newline at end of file
+#endif //IMPLEMENTATION_TREENODE_H
@@ -0,0 +1,203 @@
+//
+// TrieCounter.cpp
+//
+
+#include "TrieCounter.h"
+
+#include <algorithm>
+#include <bit>
+
+TrieCounter::TrieCounter() : nodes_(1) {}
+
+void TrieCounter::insert(std::string_view word) {
+    insert(word, 1);
+}
+
+void TrieCounter::insert(std::string_view word, size_t count) {
+    if (count == 0) return; // count 0 marks "no word here", so never store it
+
+    if (!inAlphabet(word)) {
+        others_[std::string(word)] += count;
+        return;
+    }
+
+    // Walk down from the root consuming 'word'. Work with indices throughout:
+    // nodes_ may reallocate when a node is appended.
+    std::uint32_t node = 0;
+    std::size_t pos = 0;
+    while (pos < word.size()) {
+        const int sym = symbolOf(word[pos]);
+
+        // 1) No edge for the next character: hang the whole remainder off this node.
+        if (!(nodes_[node].mask & (1u << sym))) {
+            Node leaf;
+            leaf.labelOff = static_cast<std::uint32_t>(labels_.size());
+            leaf.labelLen = static_cast<std::uint32_t>(word.size() - pos);
+            leaf.count = count;
+            labels_.append(word.substr(pos));
+            const auto id = static_cast<std::uint32_t>(nodes_.size());
+            nodes_.push_back(leaf);
+            addChild(node, sym, id);
+            ++size_;
+            return;
+        }
+
+        // 2) Follow the edge as far as it matches.
+        const std::uint32_t child = childOf(nodes_[node], sym);
+        const std::string_view label = labelOf(nodes_[child]);
+        const std::string_view rest = word.substr(pos);
+        const std::size_t common =
+            std::mismatch(label.begin(), label.end(), rest.begin(), rest.end()).first - label.begin();
+
+        // 3) The word leaves (or ends) mid-edge: split so a node exists at that point.
+        if (common < label.size()) splitEdge(child, static_cast<std::uint32_t>(common));
+
+        node = child;
+        pos += common;
+    }
+
+    // The word ends exactly at 'node'.
+    if (nodes_[node].count == 0) ++size_;
+    nodes_[node].count += count;
+}
+
+std::optional<size_t> TrieCounter::countOf(std::string_view w) const noexcept {
+    if (!inAlphabet(w)) {
+        auto it = others_.find(w);
+        if (it == others_.end()) return std::nullopt;
+        return it->second;
+    }
+
+    std::uint32_t node = 0;
+    std::size_t pos = 0;
+    while (pos < w.size()) {
+        const int sym = symbolOf(w[pos]);
+        if (!(nodes_[node].mask & (1u << sym))) return std::nullopt;
+        node = childOf(nodes_[node], sym);
+        const std::string_view label = labelOf(nodes_[node]);
+        if (w.substr(pos, label.size()) != label) return std::nullopt;
+        pos += label.size();
+    }
+    if (nodes_[node].count == 0) return std::nullopt;
+    return nodes_[node].count;
+}
+
+void TrieCounter::inorderCollect(std::vector<std::pair<std::string, size_t>>& out) const {
+    // Pre-order walk, children in symbol order: a word is emitted before every word
+    // it prefixes, and siblings come out in ascending character order, which is
+    // exactly lexicographic order. Iterative with an explicit stack.
+    const std::size_t first = out.size();
+    out.reserve(first + size_ + others_.size());
+
+    struct Frame {
+        std::uint32_t node;
+        std::uint32_t depth; // length of the word prefix above this node's label
+    };
+    std::vector<Frame> stack{{0, 0}};
+    std::string word;
+    while (!stack.empty()) {
+        const Frame f = stack.back();
+        stack.pop_back();
+        const Node& n = nodes_[f.node];
+
+        word.resize(f.depth);
+        word.append(labelOf(n));
+        if (n.count != 0) out.emplace_back(word, n.count);
+
+        // Push children last-to-first so the smallest symbol is visited next.
+        const auto depth = static_cast<std::uint32_t>(word.size());
+        for (int i = std::popcount(n.mask) - 1; i >= 0; --i) {
+            stack.push_back({slots_[n.kids + i], depth});
+        }
+    }
+
+    // Rare: words outside the alphabet. Both runs are sorted, so merge them.
+    if (!others_.empty()) {
+        const auto mid = static_cast<std::ptrdiff_t>(out.size());
+        out.insert(out.end(), others_.begin(), others_.end());
+        std::inplace_merge(out.begin() + static_cast<std::ptrdiff_t>(first), out.begin() + mid, out.end(),
+                           [](const auto& a, const auto& b) { return a.first < b.first; });
+    }
+}
+
+size_t TrieCounter::size() const noexcept {
+    return size_ + others_.size();
+}
+
+unsigned TrieCounter::height() const noexcept {
+    return 0;
+}
+
+// ===============================
+//  Private helpers
+// ===============================
+
+bool TrieCounter::inAlphabet(std::string_view w) noexcept {
+    for (char c : w) {
+        if (symbolOf(c) < 0) return false;
+    }
+    return true;
+}
+
+std::uint32_t TrieCounter::childOf(const Node& n, int sym) const noexcept {
+    // Children are packed in mask-bit order: a child's slot is the number of set
+    // bits below its own.
+    const auto rank = std::popcount(n.mask & ((1u << sym) - 1));
+    return slots_[n.kids + rank];
+}
+
+void TrieCounter::addChild(std::uint32_t parent, int sym, std::uint32_t child) {
+    const auto have = static_cast<std::uint32_t>(std::popcount(nodes_[parent].mask));
+
+    // Blocks hold a power-of-two number of slots, so a node is full exactly when its
+    // child count is a power of two (or zero). Then move to the next size class.
+    if (have == 0) {
+        nodes_[parent].kids = allocBlock(0);
+    } else if (std::has_single_bit(have)) {
+        const int cls = std::countr_zero(have);
+        const std::uint32_t fresh = allocBlock(cls + 1);
+        const std::uint32_t old = nodes_[parent].kids;
+        std::copy_n(slots_.begin() + old, have, slots_.begin() + fresh);
+        freeBlocks_[cls].push_back(old);
+        nodes_[parent].kids = fresh;
+    }
+
+    // Shift the larger symbols up one slot and drop the new child in place.
+    Node& p = nodes_[parent];
+    const auto rank = static_cast<std::uint32_t>(std::popcount(p.mask & ((1u << sym) - 1)));
+    auto base = slots_.begin() + p.kids;
+    std::copy_backward(base + rank, base + have, base + have + 1);
+    base[rank] = child;
+    p.mask |= 1u << sym;
+}
+
+std::uint32_t TrieCounter::allocBlock(int sizeClass) {
+    auto& freeList = freeBlocks_[sizeClass];
+    if (!freeList.empty()) {
+        const std::uint32_t b = freeList.back();
+        freeList.pop_back();
+        return b;
+    }
+    const auto b = static_cast<std::uint32_t>(slots_.size());
+    slots_.resize(slots_.size() + (std::size_t{1} << sizeClass));
+    return b;
+}
+
+void TrieCounter::splitEdge(std::uint32_t node, std::uint32_t keep) {
+    // Cut node's edge label after 'keep' characters. The tail becomes a new node that
+    // takes over node's count and children; node keeps the head and gets the tail as
+    // its only child. Both labels still point into the same pooled characters.
+    Node tail = nodes_[node];
+    tail.labelOff += keep;
+    tail.labelLen -= keep;
+    const int sym = symbolOf(labels_[tail.labelOff]);
+    const auto id = static_cast<std::uint32_t>(nodes_.size());
+    nodes_.push_back(tail);
+
+    Node& head = nodes_[node];
+    head.labelLen = keep;
+    head.count = 0;
+    head.mask = 0;
+    head.kids = 0;
+    addChild(node, sym, id);
+}
@@ -0,0 +1,82 @@
+//
+// TrieCounter.h
+//
+// Compressed radix trie word counter specialised for the Scanner alphabet.
+// Scanner tokens only contain 'a'..'z' and '\'', so every node can describe its
+// children with a single 27-bit mask and a packed child array:
+//
+// - Symbol index: '\'' = 0, 'a'..'z' = 1..26. This is also ASCII order ('\'' < 'a'),
+//   so visiting children in mask-bit order visits them lexicographically, and a
+//   pre-order walk emits (word, count) pairs already sorted; no final sort.
+// - Radix compression: each node carries an edge label (offset, length) into one
+//   shared character pool, so a chain of single-child nodes costs one node. Splitting
+//   an edge only adjusts the label reference; the characters are never copied.
+// - Child arrays live in one shared index vector, in power-of-two blocks (1..32 slots)
+//   recycled through per-size free lists when a node outgrows its block.
+//
+// Words with any other byte (not produced by the Scanner, but allowed by the
+// FrequencyCounter interface) are counted in a small ordered side map and merged
+// into inorderCollect()'s output.
+//
+
+#ifndef IMPLEMENTATION_TRIECOUNTER_H
+#define IMPLEMENTATION_TRIECOUNTER_H
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "FrequencyCounter.h"
+
+class TrieCounter : public FrequencyCounter {
+public:
+    TrieCounter();
+
+    void insert(std::string_view word) override;
+    void insert(std::string_view word, size_t count) override;
+
+    [[nodiscard]] std::optional<size_t> countOf(std::string_view w) const noexcept override;
+    void inorderCollect(std::vector<std::pair<std::string,size_t>>& out) const override;
+
+    [[nodiscard]] size_t size() const noexcept override;
+    [[nodiscard]] unsigned height() const noexcept override; // always 0: no BST
+
+private:
+    static constexpr int kAlphabet = 27;
+    static constexpr int kSizeClasses = 6; // child blocks of 1, 2, 4, 8, 16, 32 slots
+
+    struct Node {
+        std::uint32_t labelOff = 0; // edge label into labels_
+        std::uint32_t labelLen = 0;
+        std::uint32_t mask = 0;     // bit c set = child for symbol c exists
+        std::uint32_t kids = 0;     // first slot of this node's child block in slots_
+        std::uint64_t count = 0;    // 0 = no word ends here
+    };
+
+    std::vector<Node> nodes_;               // nodes_[0] is the root (empty label)
+    std::vector<std::uint32_t> slots_;      // child node indices, packed per node by mask order
+    std::vector<std::uint32_t> freeBlocks_[kSizeClasses];
+    std::string labels_;                    // shared edge-label characters
+    std::map<std::string, size_t, std::less<>> others_; // words outside the alphabet
+    std::size_t size_ = 0;                  // distinct words in the trie
+
+    // '\'' -> 0, 'a'..'z' -> 1..26, anything else -> -1
+    static int symbolOf(char c) noexcept {
+        if (c >= 'a' && c <= 'z') return c - 'a' + 1;
+        return c == '\'' ? 0 : -1;
+    }
+    static bool inAlphabet(std::string_view w) noexcept;
+
+    [[nodiscard]] std::string_view labelOf(const Node& n) const noexcept {
+        return {labels_.data() + n.labelOff, n.labelLen};
+    }
+    [[nodiscard]] std::uint32_t childOf(const Node& n, int sym) const noexcept; // requires bit set
+    void addChild(std::uint32_t parent, int sym, std::uint32_t child);
+    std::uint32_t allocBlock(int sizeClass);
+    void splitEdge(std::uint32_t node, std::uint32_t keep);
+};
+
+#endif //IMPLEMENTATION_TRIECOUNTER_H
@@ -0,0 +1,29 @@
+//
+// WordHash.h
+//
+// The one word hash shared by SymbolTable, HashCounter and the parallel counter.
+// They must agree: ParallelCount routes a word to a shard by its hash and stores
+// that hash in the shard's table, so every table has to compute the same value.
+//
+
+#ifndef IMPLEMENTATION_WORDHASH_H
+#define IMPLEMENTATION_WORDHASH_H
+
+#pragma once
+#include <cstdint>
+#include <string_view>
+
+// FNV-1a, then a final mix so the low (slot index) bits depend on every byte.
+inline std::uint32_t wordHash(std::string_view w) noexcept {
+    std::uint64_t h = 14695981039346656037ull;
+    for (unsigned char c : w) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    h ^= h >> 29;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 32;
+    return static_cast<std::uint32_t>(h);
+}
+
+#endif //IMPLEMENTATION_WORDHASH_H
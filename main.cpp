@@ -1,28 +1,356 @@
 // main.cpp — Part 3 end-to-end driver: Scanner → BST → .freq → Huffman(.hdr + .code
 // main.cpp — final driver: expects ./input_output/<base>.txt ONLY
+#include <charconv>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include "Scanner.hpp"
-#include "BST.h"
+#include "ScanKernel.h"
+#include "FrequencyCounter.h"
 #include "PriorityQueue.h"
 #include "HuffmanTree.h"
+#include "HuffmanDecoder.h"
+#include "AdaptiveHuffman.h"
+#include "Dictionary.h"
+#include "SymbolTable.h"
+#include "ParallelCount.h"
+#include "StringPool.h"
 
 namespace fs = std::filesystem;
 
 static void usage(const char* prog) {
-    std::cerr << "Usage: " << prog << " <base>.txt\n"
-              << "  (input file must be located in ./input_output)\n";
+    std::cerr << "Usage: " << prog << " <base>.txt [options]\n"
+              << "  (input file must be located in ./input_output)\n"
+              << "Options:\n"
+              << "  --mmap        memory-map the input and tokenize without copying\n"
+              << "  --threads=N   use N threads where a stage supports it (0 = all cores; implies --mmap)\n"
+              << "  --stream      never hold the token list: count while scanning, re-scan to encode\n"
+              << "  --intern      tokenize to integer symbol IDs; count and encode on IDs\n"
+              << "  --counter=K   frequency counter: bst (default), avl (self-balancing), hash or trie\n"
+              << "  --canonical   canonical Huffman codes; .hdr holds only words and code lengths\n"
+              << "  --max-code-length=N  limit every code to N bits (package-merge; 1..64)\n"
+              << "  --binary      write .code bit-packed (HUFB header + bytes) instead of ASCII 0/1\n"
+              << "  --blocks[=N]  write .code as a block container (N tokens per block) with a seek index; implies --mmap\n"
+              << "  --adaptive    with --blocks: give a block its own canonical tree when that is smaller\n"
+              << "  --build=B     Huffman merge: heap (default, priority queue) or twoqueue (linear after one sort)\n"
+              << "  --dynamic     single pass: adaptive (FGK) Huffman .code written while scanning, no .hdr\n"
+              << "  --train       train a reusable dictionary on this text: write <base>.dict instead of .hdr/.code\n"
+              << "  --dict=F      encode against input_output/F (a trained .dict): no counting, tree or .hdr\n"
+              << "  --decode      read <base>.hdr + <base>.code (ASCII, binary or blocks) and write <base>.decoded\n"
+              << "                (with --dict=F: read F instead of <base>.hdr)\n"
+              << "Tokenizer kernel: " << scan_kernel::implementationName() << "\n";
     std::exit(1);
 }
 
+// Optional driver switches; the defaults reproduce the original pipeline exactly.
+struct DriverOptions {
+    bool mmap = false;
+    unsigned threads = 1;
+    bool stream = false;
+    bool intern = false;
+    std::string counter = "bst";
+    HuffmanTree::BuildMethod build = HuffmanTree::BuildMethod::Heap;
+    HuffmanTree::CodeFormat format = HuffmanTree::CodeFormat::Ascii;
+    bool canonical = false;
+    unsigned maxCodeLength = 0; // 0 = unlimited
+    bool decode = false;        // run the decoder instead of the encoding pipeline
+    bool blocks = false;        // .code as a block container (BlockIndex.h)
+    std::uint64_t blockTokens = 0; // tokens per block; 0 = BlockIndex default
+    bool adaptive = false;      // per-block trees inside the block container
+    bool dynamic = false;       // one-pass adaptive Huffman stream (AdaptiveHuffman.h)
+    bool train = false;         // write <base>.dict (Dictionary.h) instead of .hdr/.code
+    std::string dict;           // encode/decode against this .dict in input_output/
+};
+
+// The whole of 's' as a decimal number in [lo, hi]; false on anything else.
+template <typename T>
+static bool parseNumber(std::string_view s, T lo, T hi, T& out) {
+    T v{};
+    const auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), v);
+    if (ec != std::errc() || end != s.data() + s.size() || v < lo || v > hi) return false;
+    out = v;
+    return true;
+}
+
+static DriverOptions parseOptions(int argc, char* argv[]) {
+    DriverOptions opts;
+    for (int i = 2; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--mmap") opts.mmap = true;
+        else if (arg == "--stream") opts.stream = true;
+        else if (arg == "--intern") opts.intern = true;
+        else if (arg.starts_with("--counter=")) {
+            opts.counter = std::string(arg.substr(10));
+            if (!makeFrequencyCounter(opts.counter)) {
+                std::cerr << "Error: unknown counter " << opts.counter << "\n";
+                usage(argv[0]);
+            }
+        }
+        else if (arg == "--canonical") opts.canonical = true;
+        else if (arg.starts_with("--max-code-length=")) {
+            if (!parseNumber(arg.substr(18), 1u, 64u, opts.maxCodeLength)) {
+                std::cerr << "Error: --max-code-length must be between 1 and 64\n";
+                usage(argv[0]);
+            }
+        }
+        else if (arg == "--decode") opts.decode = true;
+        else if (arg == "--dynamic") opts.dynamic = true;
+        else if (arg == "--train") opts.train = true;
+        else if (arg.starts_with("--dict=")) {
+            opts.dict = fs::path(std::string(arg.substr(7))).filename().string(); // input_output/ only
+            if (opts.dict.empty()) {
+                std::cerr << "Error: --dict needs a file name\n";
+                usage(argv[0]);
+            }
+        }
+        else if (arg == "--blocks") opts.blocks = opts.mmap = true;
+        else if (arg.starts_with("--blocks=")) {
+            opts.blocks = opts.mmap = true;
+            if (!parseNumber<std::uint64_t>(arg.substr(9), 1, UINT64_MAX, opts.blockTokens)) {
+                std::cerr << "Error: --blocks=N needs a token count between 1 and " << UINT64_MAX << "\n";
+                usage(argv[0]);
+            }
+        }
+        else if (arg == "--adaptive") opts.adaptive = opts.blocks = opts.mmap = true;
+        else if (arg == "--binary") opts.format = HuffmanTree::CodeFormat::Binary;
+        else if (arg == "--build=heap") opts.build = HuffmanTree::BuildMethod::Heap;
+        else if (arg == "--build=twoqueue") opts.build = HuffmanTree::BuildMethod::TwoQueue;
+        else if (arg.starts_with("--threads=")) {
+            if (!parseNumber(arg.substr(10), 0u, 1024u, opts.threads)) {
+                std::cerr << "Error: --threads must be a number between 0 and 1024\n";
+                usage(argv[0]);
+            }
+            if (opts.threads != 1) opts.mmap = true; // parallel tokenizing works on the mapping
+        }
+        else {
+            std::cerr << "Error: unknown option " << arg << "\n";
+            usage(argv[0]);
+        }
+    }
+    if (opts.stream && opts.intern) {
+        std::cerr << "Error: --stream and --intern are separate pipelines; pick one\n";
+        usage(argv[0]);
+    }
+    if (opts.dynamic && (opts.stream || opts.intern || opts.blocks || opts.canonical ||
+                         opts.maxCodeLength != 0 || opts.format != HuffmanTree::CodeFormat::Ascii)) {
+        std::cerr << "Error: --dynamic is its own one-pass pipeline; it takes no other coding options\n";
+        usage(argv[0]);
+    }
+    if ((opts.train || !opts.dict.empty()) &&
+        (opts.dynamic || opts.blocks || opts.canonical || opts.maxCodeLength != 0)) {
+        std::cerr << "Error: --train/--dict use the dictionary's own code; drop the other coding options\n";
+        usage(argv[0]);
+    }
+    if (opts.train && !opts.dict.empty()) {
+        std::cerr << "Error: --train writes a dictionary and --dict reads one; pick one\n";
+        usage(argv[0]);
+    }
+    if (!opts.dict.empty() && (opts.stream || opts.intern)) {
+        std::cerr << "Error: --dict is its own one-pass pipeline; drop --stream/--intern\n";
+        usage(argv[0]);
+    }
+    if (opts.blocks && opts.format != HuffmanTree::CodeFormat::Ascii) {
+        std::cerr << "Error: --blocks/--adaptive write their own container format; drop --binary\n";
+        usage(argv[0]);
+    }
+    if (opts.blocks && (opts.stream || opts.intern)) {
+        std::cerr << "Error: --blocks needs the in-memory token list; drop --stream/--intern\n";
+        usage(argv[0]);
+    }
+    return opts;
+}
+
+static std::size_t countLetters(std::string_view token) {
+    // Count letters a–z only (ignore apostrophes)
+    std::size_t sum = 0;
+    for (unsigned char ch : token) {
+        if (ch >= 'a' && ch <= 'z') ++sum;
+    }
+    return sum;
+}
+
+template <typename Token>
+static std::size_t countLetters(const std::vector<Token>& tokens) {
+    std::size_t sum = 0;
+    for (const auto& t : tokens) sum += countLetters(t);
+    return sum;
+}
+
+// --dynamic: one pass over the input writes .tokens and an adaptive-Huffman .code;
+// there are no counts, no .freq and no .hdr.
+static int runDynamic(const Scanner& sc, const fs::path& tokensPath, const fs::path& codePath) {
+    std::ofstream tokOut(tokensPath);
+    std::ofstream code(codePath, std::ios::binary);
+    if (!tokOut || !code) {
+        std::cerr << "Error: unable to open output .tokens/.code: " << codePath << "\n";
+        return 9;
+    }
+
+    AdaptiveHuffmanEncoder enc(code);
+    std::size_t T = 0;
+    std::size_t sum_letters = 0;
+    error_type err = NO_ERROR;
+    error_type scanErr = sc.forEachToken([&](std::string_view t) {
+        tokOut << t << '\n';
+        if (err == NO_ERROR) err = enc.put(t);
+        sum_letters += countLetters(t);
+        ++T;
+    });
+    if (scanErr != NO_ERROR) {
+        std::cerr << "Error: scanner/tokenizer failed (" << scanErr << ")\n";
+        return 4;
+    }
+    if (err == NO_ERROR) err = enc.finish();
+    if (err != NO_ERROR || !tokOut) {
+        std::cerr << "Error: failed while writing .code: " << codePath << "\n";
+        return 10;
+    }
+    std::cout << "Total tokens: " << T << "\n";
+    std::cout << "Sum of the letters in input words: " << sum_letters << "\n";
+    return 0;
+}
+
+static int loadDictionary(const fs::path& dictPath, Dictionary& dict) {
+    std::ifstream is(dictPath);
+    if (!is) {
+        std::cerr << "Error: unable to open .dict: " << dictPath << "\n";
+        return 16;
+    }
+    if (error_type err = dict.load(is); err != NO_ERROR) {
+        std::cerr << "Error: malformed .dict (" << err << "): " << dictPath << "\n";
+        return 17;
+    }
+    return 0;
+}
+
+// --dict: one pass over the input writes .tokens and a .code against a trained
+// dictionary; there are no counts, no tree, no .freq and no .hdr.
+static int runWithDictionary(const Scanner& sc, const fs::path& dictPath, const fs::path& tokensPath,
+                             const fs::path& codePath, HuffmanTree::CodeFormat format) {
+    Dictionary dict;
+    if (int rc = loadDictionary(dictPath, dict); rc != 0) return rc;
+
+    std::ofstream tokOut(tokensPath);
+    std::ofstream code(codePath, std::ios::binary);
+    if (!tokOut || !code) {
+        std::cerr << "Error: unable to open output .tokens/.code: " << codePath << "\n";
+        return 9;
+    }
+
+    Dictionary::Encoder enc(dict, code, 80, format);
+    std::size_t T = 0;
+    std::size_t sum_letters = 0;
+    error_type err = NO_ERROR;
+    error_type scanErr = sc.forEachToken([&](std::string_view t) {
+        tokOut << t << '\n';
+        if (err == NO_ERROR) err = enc.put(t);
+        sum_letters += countLetters(t);
+        ++T;
+    });
+    if (scanErr != NO_ERROR) {
+        std::cerr << "Error: scanner/tokenizer failed (" << scanErr << ")\n";
+        return 4;
+    }
+    if (err == NO_ERROR) err = enc.finish();
+    if (err != NO_ERROR || !tokOut) {
+        std::cerr << "Error: failed while writing .code: " << codePath << "\n";
+        return 10;
+    }
+    std::cout << "Dictionary words: " << dict.size() << "\n";
+    std::cout << "Total tokens: " << T << "\n";
+    std::cout << "Out-of-vocabulary tokens: " << enc.escaped() << "\n";
+    std::cout << "Sum of the letters in input words: " << sum_letters << "\n";
+    return 0;
+}
+
+// --decode: <base>.hdr + <base>.code → <base>.decoded (same format as .tokens).
+// An adaptive (--dynamic) .code carries its own model and needs no .hdr; with
+// --dict the dictionary stands in for the .hdr.
+static int runDecode(const fs::path& dir, const std::string& base, unsigned threads,
+                     const std::string& dictName) {
+    const fs::path hdrPath     = dir / (base + ".hdr");
+    const fs::path codePath    = dir / (base + ".code");
+    const fs::path decodedPath = dir / (base + ".decoded");
+
+    if (!dictName.empty()) {
+        Dictionary dict;
+        if (int rc = loadDictionary(dir / dictName, dict); rc != 0) return rc;
+        std::ifstream code(codePath, std::ios::binary);
+        if (!code) {
+            std::cerr << "Error: unable to open .code: " << codePath << "\n";
+            return 13;
+        }
+        std::ofstream out(decodedPath, std::ios::binary);
+        if (!out) {
+            std::cerr << "Error: unable to open output .decoded: " << decodedPath << "\n";
+            return 14;
+        }
+        if (error_type err = dict.decode(code, out); err != NO_ERROR || !out) {
+            std::cerr << "Error: failed while decoding (" << err << ") " << codePath << "\n";
+            return 15;
+        }
+        return 0;
+    }
+
+    {
+        std::ifstream code(codePath, std::ios::binary);
+        char magic[4] = {};
+        if (code.read(magic, sizeof magic) &&
+            std::string_view(magic, sizeof magic) == AdaptiveHuffmanDecoder::kMagic) {
+            code.seekg(0);
+            std::ofstream out(decodedPath, std::ios::binary);
+            if (!out) {
+                std::cerr << "Error: unable to open output .decoded: " << decodedPath << "\n";
+                return 14;
+            }
+            if (error_type err = AdaptiveHuffmanDecoder::decode(code, out); err != NO_ERROR || !out) {
+                std::cerr << "Error: failed while decoding (" << err << ") " << codePath << "\n";
+                return 15;
+            }
+            return 0;
+        }
+    }
+
+    HuffmanDecoder decoder;
+    {
+        std::ifstream hdr(hdrPath);
+        if (!hdr) {
+            std::cerr << "Error: unable to open .hdr: " << hdrPath << "\n";
+            return 11;
+        }
+        if (error_type err = decoder.loadHeader(hdr); err != NO_ERROR) {
+            std::cerr << "Error: malformed .hdr (" << err << "): " << hdrPath << "\n";
+            return 12;
+        }
+    }
+
+    std::ifstream code(codePath, std::ios::binary);
+    if (!code) {
+        std::cerr << "Error: unable to open .code: " << codePath << "\n";
+        return 13;
+    }
+    std::ofstream out(decodedPath, std::ios::binary);
+    if (!out) {
+        std::cerr << "Error: unable to open output .decoded: " << decodedPath << "\n";
+        return 14;
+    }
+    if (error_type err = decoder.decode(code, out, threads); err != NO_ERROR || !out) {
+        std::cerr << "Error: failed while decoding (" << err << ") " << codePath << "\n";
+        return 15;
+    }
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
-    if (argc != 2) usage(argv[0]);
+    if (argc < 2) usage(argv[0]);
+    const DriverOptions opts = parseOptions(argc, argv);
 
     // Enforce input_output/ policy
     fs::path filename = fs::path(argv[1]).filename();     // ignore any path the user passed
@@ -37,6 +365,9 @@ int main(int argc, char* argv[]) {
         return 2;
     }
 
+    // Decoding only needs the .hdr and .code, not the original text.
+    if (opts.decode) return runDecode(dir, fs::path(filename).stem().string(), opts.threads, opts.dict);
+
     fs::path in = dir / filename;
     std::ifstream fin(in);
     if (!fin) {
@@ -52,38 +383,89 @@ int main(int argc, char* argv[]) {
     fs::path codePath   = dir / (base + ".code");
 
     // 1) Scanner → tokens + .tokens
+    //    With --mmap the tokens are views into the Scanner's mapping, so 'sc' must
+    //    stay alive until encoding is done.
+    //    With --stream no token list exists at all: this pass writes .tokens and
+    //    counts as it goes, and step 4 re-scans the file to encode.
+    //    With --intern tokens are symbol IDs; counting runs on an integer array and the
+    //    counter only sees each distinct word once.
+    Scanner sc{in};
+    if (opts.dynamic) return runDynamic(sc, tokensPath, codePath);
+    if (!opts.dict.empty()) return runWithDictionary(sc, dir / opts.dict, tokensPath, codePath, opts.format);
     std::vector<std::string> tokens;
+    std::vector<std::string_view> views;
+    SymbolTable symbols;
+    std::vector<std::uint32_t> ids;
     std::size_t sum_letters = 0;
-    {
-        Scanner sc{in};
-        error_type err = sc.tokenize(tokens, tokensPath);
-
-        // Sum of the letters in input words
-        // Count letters a–z only (ignore apostrophes)
-        for (const auto& t : tokens) {
-            for (unsigned char ch : t) {
-                if (ch >= 'a' && ch <= 'z') ++sum_letters;
-            }
+    std::size_t T = 0;
+
+    // 2) Frequency counter (--counter picks the backend) → counts (lex by word).
+    //    Each branch below does step 1 and feeds step 2 in the way its mode allows.
+    std::unique_ptr<FrequencyCounter> counter = makeFrequencyCounter(opts.counter);
+    if (opts.stream) {
+        std::ofstream tokOut(tokensPath);
+        error_type err = tokOut ? sc.forEachToken([&](std::string_view t) {
+                                      tokOut << t << '\n';
+                                      counter->insert(t);
+                                      sum_letters += countLetters(t);
+                                      ++T;
+                                  })
+                                : UNABLE_TO_OPEN_FILE_FOR_WRITING;
+        if (err == NO_ERROR && !tokOut) err = FAILED_TO_WRITE_FILE;
+        if (err != NO_ERROR) {
+            std::cerr << "Error: scanner/tokenizer failed (" << err << ") for " << in << "\n";
+            return 4;
+        }
+    } else if (opts.intern) {
+        error_type err = sc.tokenizeSymbols(symbols, ids, tokensPath);
+        if (err != NO_ERROR) {
+            std::cerr << "Error: scanner/tokenizer failed (" << err << ") for " << in << "\n";
+            return 4;
+        }
+        T = ids.size();
+
+        // Count on IDs, then hand the counter one pre-counted insert per distinct word.
+        // IDs are in first-seen order, which is the order a tree counter would have
+        // created its nodes in, so the tree (and its height) is the same.
+        std::vector<std::size_t> idCounts(symbols.size(), 0);
+        for (const std::uint32_t id : ids) ++idCounts[id];
+        for (std::uint32_t id = 0; id < idCounts.size(); ++id) {
+            counter->insert(symbols.word(id), idCounts[id]);
+            sum_letters += idCounts[id] * countLetters(symbols.word(id));
         }
+    } else {
+        error_type err = opts.threads != 1 ? sc.tokenizeParallel(views, tokensPath, opts.threads)
+                       : opts.mmap         ? sc.tokenizeMapped(views, tokensPath)
+                                           : sc.tokenize(tokens, tokensPath);
 
         if (err != NO_ERROR) {
             std::cerr << "Error: scanner/tokenizer failed (" << err << ") for " << in << "\n";
             return 4;
         }
+        T = opts.mmap ? views.size() : tokens.size();
+
+        if (opts.threads != 1) {
+            // Count on all threads, then (as with --intern) hand the counter one
+            // pre-counted insert per distinct word, in first-seen order.
+            for (const auto& [w, c] : countParallel(views, opts.threads)) {
+                counter->insert(w, c);
+                sum_letters += c * countLetters(w);
+            }
+        } else {
+            // Sum of the letters in input words
+            sum_letters = opts.mmap ? countLetters(views) : countLetters(tokens);
+            if (opts.mmap) counter->bulkInsert(views);
+            else           counter->bulkInsert(tokens);
+        }
     }
 
-    // 2) BST → counts (lex by word)
-    BST bst;
-    bst.bulkInsert(tokens);
-
     std::vector<std::pair<std::string, std::size_t>> counts_lex;
-    counts_lex.reserve(bst.size());
-    bst.inorderCollect(counts_lex); // appends in word-ascending order
+    counts_lex.reserve(counter->size());
+    counter->inorderCollect(counts_lex); // appends in word-ascending order
 
-    // Required BST stats
-    unsigned H = bst.height();
-    std::size_t U = bst.size();
-    std::size_t T = tokens.size();
+    // Required BST stats (height of whichever counter was used; 0 for "hash"/"trie")
+    unsigned H = counter->height();
+    std::size_t U = counter->size();
     std::size_t MIN = 0, MAX = 0;
     if (!counts_lex.empty()) {
         MIN = counts_lex.front().second;
@@ -99,19 +481,19 @@ int main(int argc, char* argv[]) {
     std::cout << "Min frequency: " << MIN << "\n";
     std::cout << "Max frequency: " << MAX << "\n";
 
-    // 3) .freq via PriorityQueue (count desc, tie key_word/word asc)
+    // 3) .freq via PriorityQueue (count desc, tie word asc)
     {
-        std::vector<std::unique_ptr<TreeNode>> owners;
-        owners.reserve(counts_lex.size());
+        // Leaves live in one vector and reference their words in one pool.
+        // counts_lex is in word order, so rank i is the lexicographic tie-break key.
+        StringPool words;
+        std::vector<TreeNode> leaves;
+        leaves.reserve(counts_lex.size());
         std::vector<TreeNode*> raw;
         raw.reserve(counts_lex.size());
 
         for (const auto& [w, c] : counts_lex) {
-            auto node = std::make_unique<TreeNode>(w); // if you have (w,c) ctor, use it instead
-            node->count = c;
-            node->left = node->right = nullptr;
-            raw.push_back(node.get());
-            owners.emplace_back(std::move(node));
+            const auto rank = static_cast<std::uint32_t>(leaves.size());
+            raw.push_back(&leaves.emplace_back(words.add(w), c, rank));
         }
 
         PriorityQueue pq(std::move(raw));
@@ -120,15 +502,34 @@ int main(int argc, char* argv[]) {
             std::cerr << "Error: unable to open output .freq: " << freqPath << "\n";
             return 5;
         }
-        pq.print(ofs); // uses setw(10) << count << ' ' << word << '\n'
+        pq.print(words, ofs); // uses setw(10) << count << ' ' << word << '\n'
         if (!ofs) {
             std::cerr << "Error: failed while writing .freq: " << freqPath << "\n";
             return 6;
         }
     }
 
+    // --train: the counts become a reusable dictionary; this text gets no .hdr/.code.
+    if (opts.train) {
+        const fs::path dictPath = dir / (base + ".dict");
+        const Dictionary dict = Dictionary::train(counts_lex, opts.build);
+        std::ofstream os(dictPath);
+        if (!os) {
+            std::cerr << "Error: unable to open output .dict: " << dictPath << "\n";
+            return 7;
+        }
+        if (error_type err = dict.save(os); err != NO_ERROR || !os) {
+            std::cerr << "Error: failed while writing .dict: " << dictPath << "\n";
+            return 8;
+        }
+        std::cout << "Dictionary words: " << dict.size() << "\n";
+        std::cout << "Sum of the letters in input words: " << sum_letters << "\n";
+        return 0;
+    }
+
     // 4) Huffman tree → .hdr and .code
-    HuffmanTree htree = HuffmanTree::buildFromCounts(counts_lex);
+    HuffmanTree htree = HuffmanTree::buildFromCounts(counts_lex, opts.build, opts.maxCodeLength);
+    if (opts.canonical) htree.canonicalize(); // same lengths, canonical codes + compact .hdr
 
     // .hdr (pre-order over leaves: "word code")
     {
@@ -144,14 +545,32 @@ int main(int argc, char* argv[]) {
         }
     }
 
-    // .code (ASCII 0/1 wrapped to 80 cols, final newline)
+    // .code (ASCII 0/1 wrapped to 80 cols, final newline; or bit-packed with --binary;
+    // or a block container with --blocks)
     {
-        std::ofstream code(codePath);
+        std::ofstream code(codePath, std::ios::binary);
         if (!code) {
             std::cerr << "Error: unable to open output .code: " << codePath << "\n";
             return 9;
         }
-        error_type err = htree.encode(tokens, code, 80);
+        error_type err = NO_ERROR;
+        if (opts.stream) {
+            // Second pass over the input instead of a stored token list
+            HuffmanTree::Encoder enc(htree, code, 80, opts.format);
+            error_type scanErr = sc.forEachToken([&](std::string_view t) {
+                if (err == NO_ERROR) err = enc.put(t);
+            });
+            if (err == NO_ERROR) err = scanErr;
+            if (err == NO_ERROR) err = enc.finish();
+        } else if (opts.blocks) {
+            err = htree.encodeBlocks(views, code, opts.blockTokens, opts.threads, opts.adaptive);
+        } else if (opts.intern) {
+            err = htree.encode(ids, symbols, code, 80, opts.format);
+        } else {
+            err = opts.threads != 1 ? htree.encodeParallel(views, code, 80, opts.format, opts.threads)
+                : opts.mmap         ? htree.encode(views, code, 80, opts.format)
+                                    : htree.encode(tokens, code, 80, opts.format);
+        }
         if (err != NO_ERROR || !code) {
             std::cerr << "Error: failed while writing .code: " << codePath << "\n";
             return 10;
@@ -0,0 +1,121 @@
+//
+// huffman_tests.cpp
+//
+// Checks that BuildMethod::TwoQueue builds the same tree as BuildMethod::Heap: the
+// .hdr bytes (plain and canonical) must be identical for every corpus below.
+//   - input_output/TheBells.txt (path overridable by argv[1])
+//   - synthetic Zipf counts for several exponents, all-equal counts, and
+//     alphabets of 1-3 symbols
+// Exits non-zero if any corpus differs.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../HuffmanTree.h"
+#include "../Scanner.hpp"
+
+namespace {
+    using Counts = std::vector<std::pair<std::string, std::size_t>>;
+
+    std::string header(const Counts& counts, HuffmanTree::BuildMethod method, bool canonical) {
+        HuffmanTree tree = HuffmanTree::buildFromCounts(counts, method);
+        if (canonical) tree.canonicalize();
+        std::ostringstream os;
+        tree.writeHeader(os);
+        return os.str();
+    }
+
+    int failures = 0;
+
+    void expectSameHeader(const std::string& name, const Counts& counts) {
+        for (const bool canonical : {false, true}) {
+            const std::string heap = header(counts, HuffmanTree::BuildMethod::Heap, canonical);
+            const std::string twoQueue = header(counts, HuffmanTree::BuildMethod::TwoQueue, canonical);
+            const char* form = canonical ? " (canonical)" : "";
+            if (heap != twoQueue) {
+                std::cerr << "FAIL " << name << form << ": heap and twoqueue .hdr differ\n";
+                ++failures;
+            } else {
+                std::cout << "ok   " << name << form << " (" << counts.size() << " words)\n";
+            }
+        }
+    }
+
+    // Word-ascending counts, as FrequencyCounter::inorderCollect hands them over.
+    Counts fromMap(const std::map<std::string, std::size_t>& m) {
+        return {m.begin(), m.end()};
+    }
+
+    Counts theBells(const std::string& path) {
+        std::vector<std::string> tokens;
+        Scanner sc{path};
+        if (sc.tokenize(tokens) != NO_ERROR) {
+            std::cerr << "FAIL cannot read " << path << "\n";
+            ++failures;
+            return {};
+        }
+        std::map<std::string, std::size_t> m;
+        for (const auto& t : tokens) ++m[t];
+        return fromMap(m);
+    }
+
+    // V words with count ~ scale / rank^s; ranks are shuffled across the words so the
+    // count order and the word order differ.
+    Counts zipf(std::size_t V, double s, std::size_t scale, unsigned seed) {
+        std::vector<std::size_t> rank(V);
+        for (std::size_t i = 0; i < V; ++i) rank[i] = i + 1;
+        std::mt19937 rng(seed);
+        std::shuffle(rank.begin(), rank.end(), rng);
+
+        std::map<std::string, std::size_t> m;
+        for (std::size_t i = 0; i < V; ++i) {
+            const auto c = static_cast<std::size_t>(std::llround(static_cast<double>(scale) / std::pow(static_cast<double>(rank[i]), s)));
+            m["w" + std::to_string(i)] = std::max<std::size_t>(1, c);
+        }
+        return fromMap(m);
+    }
+
+    Counts equal(std::size_t V, std::size_t count) {
+        std::map<std::string, std::size_t> m;
+        for (std::size_t i = 0; i < V; ++i) m["w" + std::to_string(i)] = count;
+        return fromMap(m);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const std::string bells = argc > 1 ? argv[1] : "input_output/TheBells.txt";
+    if (const Counts c = theBells(bells); !c.empty()) expectSameHeader("TheBells", c);
+
+    for (const double s : {0.5, 0.8, 1.0, 1.2, 1.5, 2.0}) {
+        for (const std::size_t V : {std::size_t{100}, std::size_t{5000}, std::size_t{60000}}) {
+            std::ostringstream name;
+            name << "zipf s=" << s << " V=" << V;
+            expectSameHeader(name.str(), zipf(V, s, 1000000, 42));
+        }
+    }
+
+    expectSameHeader("all-equal V=1000", equal(1000, 7));
+    expectSameHeader("all-equal V=1024", equal(1024, 1));
+
+    expectSameHeader("one symbol", {{"a", 5}});
+    expectSameHeader("two symbols", {{"a", 3}, {"b", 9}});
+    expectSameHeader("two symbols, tie", {{"a", 4}, {"b", 4}});
+    expectSameHeader("three symbols", {{"a", 1}, {"b", 2}, {"c", 3}});
+    expectSameHeader("three symbols, tie", {{"a", 2}, {"b", 2}, {"c", 2}});
+    expectSameHeader("three symbols, split tie", {{"a", 5}, {"b", 1}, {"c", 1}});
+
+    if (failures != 0) {
+        std::cerr << failures << " failure(s)\n";
+        return 1;
+    }
+    return 0;
+}
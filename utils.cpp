@@ -31,6 +31,10 @@ void exitOnError(error_type error, const std::string &entityName = "") {
             std::cerr << "Error: Unable to open " << entityName << " for writing. Terminating...\n";
             exit(UNABLE_TO_OPEN_FILE_FOR_WRITING);
 
+        case CORRUPT_INPUT:
+            std::cerr << "Error: " << entityName << " is malformed or does not match its header. Terminating...\n";
+            exit(CORRUPT_INPUT);
+
         default:
             std::cerr << "Error: Unknown error type. Terminating...\n";
             exit(ERR_TYPE_NOT_FOUND);
@@ -118,3 +122,23 @@ error_type writeVectorToFile(const std::string& filename,
     return NO_ERROR;
 }
 
+
+error_type writeVectorToFile(const std::string& filename,
+                       const std::vector<std::string_view>& data) {
+    // Same as above, for tokens produced by the zero-copy Scanner mode.
+
+    std::ofstream out(filename, std::ios::out | std::ios::trunc);
+    if (!out.is_open()) {
+        return UNABLE_TO_OPEN_FILE_FOR_WRITING;
+    }
+
+    for (const auto& item : data) {
+        out << item << '\n';
+        if (!out) {
+            std::cerr << "Error: failed while writing to " << filename << "\n";
+            return FAILED_TO_WRITE_FILE;
+        }
+    }
+
+    return NO_ERROR;
+}
@@ -4,6 +4,8 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <vector>
 
 #ifndef IMPLEMENTATION_UTILS_HPP
 #define IMPLEMENTATION_UTILS_HPP
@@ -17,6 +19,7 @@ enum error_type {
     ERR_TYPE_NOT_FOUND,
     UNABLE_TO_OPEN_FILE_FOR_WRITING,
     FAILED_TO_WRITE_FILE,
+    CORRUPT_INPUT,
 };
 
 void exitOnError(error_type error, const std::string& entityName);
@@ -28,5 +31,7 @@ std::string baseNameWithoutTxt(const std::string& filename);
 error_type canOpenForWriting(const std::string& filename);
 error_type writeVectorToFile(const std::string& filename,
                              const std::vector<std::string> & lines);
+error_type writeVectorToFile(const std::string& filename,
+                             const std::vector<std::string_view> & lines);
 
 #endif //IMPLEMENTATION_UTILS_HPP
\ No newline at end of file